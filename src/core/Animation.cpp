@@ -0,0 +1,80 @@
+#include "Animation.hpp"
+#include <algorithm>
+
+static float ease(eEasing easing, float t) {
+    switch (easing) {
+        case EASE_OUT_CUBIC: return 1.f - (1.f - t) * (1.f - t) * (1.f - t);
+        case EASE_IN_OUT_CUBIC: return t < 0.5f ? 4.f * t * t * t : 1.f - (-2.f * t + 2.f) * (-2.f * t + 2.f) * (-2.f * t + 2.f) / 2.f;
+        default: return t;
+    }
+}
+
+CAnimation::CAnimation(float value, std::chrono::steady_clock::duration duration_, eEasing easing_) : from(value), to(value), duration(duration_), easing(easing_) {
+    g_pAnimationManager->addAnimation(this);
+}
+
+CAnimation::~CAnimation() {
+    if (g_pAnimationManager)
+        g_pAnimationManager->removeAnimation(this);
+}
+
+void CAnimation::animateTo(float goal) {
+    if (goal == to)
+        return;
+
+    from  = value();
+    to    = goal;
+    begin = std::chrono::steady_clock::now();
+}
+
+void CAnimation::warp(float value) {
+    from  = value;
+    to    = value;
+    begin = {};
+}
+
+void CAnimation::setDuration(const std::chrono::steady_clock::duration& duration_) {
+    duration = duration_;
+}
+
+float CAnimation::value() const {
+    if (from == to || duration.count() <= 0)
+        return to;
+
+    // started after the last tick, that is progress 0
+    const auto ELAPSED = std::chrono::duration<float>(g_pAnimationManager->frameTime() - begin) / std::chrono::duration<float>(duration);
+    const auto T       = std::clamp(ELAPSED, 0.f, 1.f);
+
+    if (T >= 1.f)
+        return to;
+
+    return from + (to - from) * ease(easing, T);
+}
+
+float CAnimation::goal() const {
+    return to;
+}
+
+bool CAnimation::running() const {
+    return from != to && duration.count() > 0 && g_pAnimationManager->frameTime() < begin + duration;
+}
+
+void CAnimationManager::tick() {
+    m_tFrameTime = std::chrono::steady_clock::now();
+}
+
+std::chrono::steady_clock::time_point CAnimationManager::frameTime() const {
+    return m_tFrameTime;
+}
+
+bool CAnimationManager::animating() const {
+    return std::ranges::any_of(m_vAnimations, [](const auto* a) { return a->running(); });
+}
+
+void CAnimationManager::addAnimation(CAnimation* animation) {
+    m_vAnimations.push_back(animation);
+}
+
+void CAnimationManager::removeAnimation(CAnimation* animation) {
+    std::erase(m_vAnimations, animation);
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <chrono>
+#include <memory>
+#include <vector>
+
+enum eEasing : uint8_t {
+    EASE_LINEAR = 0,
+    EASE_OUT_CUBIC,
+    EASE_IN_OUT_CUBIC,
+};
+
+// A float moving from one value to another over a fixed duration.
+// Progress is taken from the frame time of CAnimationManager, which is on steady_clock, so clock changes don't make it jump.
+class CAnimation {
+  public:
+    CAnimation(float value, std::chrono::steady_clock::duration duration, eEasing easing = EASE_LINEAR);
+    ~CAnimation();
+
+    CAnimation(const CAnimation&)            = delete;
+    CAnimation& operator=(const CAnimation&) = delete;
+
+    // Animates from the current value to goal. Does nothing if it is already heading there.
+    void  animateTo(float goal);
+    // Jumps to value without animating.
+    void  warp(float value);
+
+    void  setDuration(const std::chrono::steady_clock::duration& duration);
+
+    float value() const;
+    float goal() const;
+    bool  running() const;
+
+  private:
+    float                                 from = 0;
+    float                                 to   = 0;
+    std::chrono::steady_clock::time_point begin;
+    std::chrono::steady_clock::duration   duration;
+    eEasing                               easing = EASE_LINEAR;
+};
+
+// Keeps track of all animations, so there is one place to ask whether another frame is needed.
+class CAnimationManager {
+  public:
+    // Samples the frame time. Called once before rendering, so every animation in a frame agrees on the time.
+    void                                  tick();
+    std::chrono::steady_clock::time_point frameTime() const;
+
+    // true while any animation has not settled yet
+    bool                                  animating() const;
+
+    void                                  addAnimation(CAnimation* animation);
+    void                                  removeAnimation(CAnimation* animation);
+
+  private:
+    std::chrono::steady_clock::time_point m_tFrameTime = std::chrono::steady_clock::now();
+    std::vector<CAnimation*>              m_vAnimations;
+};
+
+inline std::unique_ptr<CAnimationManager> g_pAnimationManager;
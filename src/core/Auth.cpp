@@ -15,7 +15,8 @@
 #include <thread>
 
 int conv(int num_msg, const struct pam_message** msg, struct pam_response** resp, void* appdata_ptr) {
-    const auto           CONVERSATIONSTATE = (CAuth::SPamConversationState*)appdata_ptr;
+    const auto           AUTH              = (CAuth*)appdata_ptr;
+    const auto           CONVERSATIONSTATE = &AUTH->m_sConversationState;
     struct pam_response* pamReply          = (struct pam_response*)calloc(num_msg, sizeof(struct pam_response));
     bool                 initialPrompt     = true;
 
@@ -27,18 +28,16 @@ int conv(int num_msg, const struct pam_message** msg, struct pam_response** resp
                 const auto PROMPTCHANGED = PROMPT != CONVERSATIONSTATE->prompt;
                 Debug::log(LOG, "PAM_PROMPT: {}", PROMPT);
 
-                if (PROMPTCHANGED)
-                    g_pHyprlock->enqueueForceUpdateTimers();
-
                 // Some pam configurations ask for the password twice for whatever reason (Fedora su for example)
                 // When the prompt is the same as the last one, I guess our answer can be the same.
                 if (!initialPrompt && PROMPTCHANGED) {
                     CONVERSATIONSTATE->prompt = PROMPT;
-                    g_pAuth->waitForInput();
+                    g_pHyprlock->enqueueVariableUpdate("PROMPT");
+                    AUTH->waitForInput();
                 }
 
-                // Needed for unlocks via SIGUSR1
-                if (g_pHyprlock->isUnlocked())
+                // Needed for unlocks via SIGUSR1 and for a conversation that outlived its lock
+                if (g_pHyprlock->isUnlocked() || AUTH->isTerminated())
                     return PAM_CONV_ERR;
 
                 pamReply[i].resp = strdup(CONVERSATIONSTATE->input.c_str());
@@ -70,35 +69,58 @@ CAuth::CAuth() {
     }
 }
 
-static void passwordCheckTimerCallback(std::shared_ptr<CTimer> self, void* data) {
-    g_pHyprlock->onPasswordCheckTimer();
+CAuth::~CAuth() {
+    // the thread holds a reference until it is joined, this only happens when bailing out early
+    if (m_tAuthThread.joinable())
+        m_tAuthThread.detach();
 }
 
 void CAuth::start() {
-    std::thread([this]() {
-        resetConversation();
+    // only called once the previous run posted its result, so this does not wait on pam
+    if (m_tAuthThread.joinable())
+        m_tAuthThread.join();
+
+    m_tAuthThread = std::thread([self = shared_from_this()]() mutable {
+        self->run();
+
+        // pam may block for a long time, so the main thread never waits on it. Join from the event loop once we are done.
+        // The task takes our reference, the last one may drop there but never on this thread.
+        const auto ID = std::this_thread::get_id();
+        g_pHyprlock->addTask([self = std::move(self), ID]() {
+            if (self->m_tAuthThread.joinable() && self->m_tAuthThread.get_id() == ID)
+                self->m_tAuthThread.join();
+        });
+    });
+}
+
+void CAuth::run() {
+    resetConversation();
 
-        // Initial input
-        m_sConversationState.prompt = "Password: ";
-        waitForInput();
+    // Initial input
+    m_sConversationState.prompt = "Password: ";
+    g_pHyprlock->enqueueVariableUpdate("PROMPT");
+    waitForInput();
 
-        // For grace or SIGUSR1 unlocks
-        if (g_pHyprlock->isUnlocked())
-            return;
+    // For grace or SIGUSR1 unlocks
+    if (g_pHyprlock->isUnlocked() || isTerminated())
+        return;
 
-        const auto AUTHENTICATED = auth();
-        m_bAuthenticated         = AUTHENTICATED;
+    const auto AUTHENTICATED = auth();
+    m_bAuthenticated         = AUTHENTICATED;
 
-        // For SIGUSR1 unlocks
-        if (g_pHyprlock->isUnlocked())
-            return;
+    // For SIGUSR1 unlocks
+    if (g_pHyprlock->isUnlocked() || isTerminated())
+        return;
 
-        g_pHyprlock->addTimer(std::chrono::milliseconds(1), passwordCheckTimerCallback, nullptr);
-    }).detach();
+    // a daemon may already be on its next lock with a new CAuth
+    g_pHyprlock->addTask([this]() {
+        if (g_pAuth.get() == this)
+            g_pHyprlock->onPasswordCheckTimer();
+    });
 }
 
 bool CAuth::auth() {
-    const pam_conv localConv   = {conv, (void*)&m_sConversationState};
+    const pam_conv localConv   = {conv, (void*)this};
     pam_handle_t*  handle      = NULL;
     auto           uidPassword = getpwuid(getuid());
 
@@ -133,19 +155,15 @@ bool CAuth::isAuthenticated() {
     return m_bAuthenticated;
 }
 
-// clearing the input must be done from the main thread
-static void clearInputTimerCallback(std::shared_ptr<CTimer> self, void* data) {
-    g_pHyprlock->clearPasswordBuffer();
-}
-
 void CAuth::waitForInput() {
-    g_pHyprlock->addTimer(std::chrono::milliseconds(1), clearInputTimerCallback, nullptr);
+    // clearing the input must be done from the main thread
+    g_pHyprlock->addTask([]() { g_pHyprlock->clearPasswordBuffer(); });
 
     std::unique_lock<std::mutex> lk(m_sConversationState.inputMutex);
     m_bBlockInput                          = false;
     m_sConversationState.waitingForPamAuth = false;
     m_sConversationState.inputRequested    = true;
-    m_sConversationState.inputSubmittedCondition.wait(lk, [this] { return !m_sConversationState.inputRequested || g_pHyprlock->m_bTerminate; });
+    m_sConversationState.inputSubmittedCondition.wait(lk, [this] { return !m_sConversationState.inputRequested || m_sConversationState.terminated; });
     m_bBlockInput = true;
 }
 
@@ -174,7 +192,18 @@ bool CAuth::checkWaiting() {
 }
 
 void CAuth::terminate() {
-    m_sConversationState.inputSubmittedCondition.notify_all();
+    {
+        std::lock_guard<std::mutex> lg(m_sConversationState.inputMutex);
+        m_sConversationState.terminated = true;
+        m_sConversationState.inputSubmittedCondition.notify_all();
+    }
+
+    // pam_authenticate might not return for a while, the thread joins itself via the event loop when it does
+}
+
+bool CAuth::isTerminated() {
+    std::lock_guard<std::mutex> lg(m_sConversationState.inputMutex);
+    return m_sConversationState.terminated;
 }
 
 void CAuth::resetConversation() {
@@ -5,8 +5,9 @@
 #include <string>
 #include <mutex>
 #include <condition_variable>
+#include <thread>
 
-class CAuth {
+class CAuth : public std::enable_shared_from_this<CAuth> {
   public:
     struct SPamConversationState {
         std::string             input    = "";
@@ -19,9 +20,11 @@ class CAuth {
         bool                    waitingForPamAuth = false;
         bool                    inputRequested    = false;
         bool                    failTextFromPam   = false;
+        bool                    terminated        = false;
     };
 
     CAuth();
+    ~CAuth();
 
     void                       start();
     bool                       auth();
@@ -35,7 +38,9 @@ class CAuth {
 
     bool                       checkWaiting();
 
+    // Stops the auth thread without waiting on it, it is joined from the event loop once pam returns
     void                       terminate();
+    bool                       isTerminated();
 
     // Should only be set via the main thread
     bool m_bDisplayFailText = false;
@@ -48,7 +53,12 @@ class CAuth {
 
     std::string           m_sPamModule;
 
+    std::thread           m_tAuthThread;
+
+    void                  run();
     void                  resetConversation();
+
+    friend int            conv(int num_msg, const struct pam_message** msg, struct pam_response** resp, void* appdata_ptr);
 };
 
-inline std::unique_ptr<CAuth> g_pAuth;
+inline std::shared_ptr<CAuth> g_pAuth;
@@ -0,0 +1,150 @@
+#include "ControlSocket.hpp"
+#include "hyprlock.hpp"
+#include "../helpers/Log.hpp"
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <errno.h>
+#include <cstring>
+
+// a command is one short line, anything longer is garbage
+constexpr size_t MAX_COMMAND_LENGTH = 4096;
+
+CControlSocket::CControlSocket() {
+    registerCommand("help", [this](const std::string&) {
+        std::string commands;
+        for (const auto& [name, handler] : m_mCommands) {
+            commands += (commands.empty() ? "" : " ") + name;
+        }
+        return commands;
+    });
+}
+
+CControlSocket::~CControlSocket() {
+    for (const auto& [fd, pending] : m_mClients) {
+        g_pHyprlock->m_pEventLoop->removeFd(fd);
+        close(fd);
+    }
+
+    if (m_iSocketFD < 0)
+        return;
+
+    g_pHyprlock->m_pEventLoop->removeFd(m_iSocketFD);
+    close(m_iSocketFD);
+    unlink(m_szSocketPath.c_str());
+}
+
+bool CControlSocket::start() {
+    const auto RUNTIMEDIR = getenv("XDG_RUNTIME_DIR");
+    if (!RUNTIMEDIR) {
+        Debug::log(ERR, "[socket] XDG_RUNTIME_DIR is not set, can't create the control socket");
+        return false;
+    }
+
+    m_szSocketPath = std::string{RUNTIMEDIR} + "/hyprlock.sock";
+
+    sockaddr_un addr = {.sun_family = AF_UNIX};
+    if (m_szSocketPath.length() >= sizeof(addr.sun_path)) {
+        Debug::log(ERR, "[socket] Socket path {} is too long", m_szSocketPath);
+        return false;
+    }
+    strncpy(addr.sun_path, m_szSocketPath.c_str(), sizeof(addr.sun_path) - 1);
+
+    m_iSocketFD = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC | SOCK_NONBLOCK, 0);
+    if (m_iSocketFD < 0) {
+        Debug::log(ERR, "[socket] Failed to create the control socket: {}", errno);
+        return false;
+    }
+
+    // a socket nobody listens on is a leftover from a crash
+    if (connect(m_iSocketFD, (sockaddr*)&addr, SUN_LEN(&addr)) == 0) {
+        Debug::log(ERR, "[socket] {} is in use, is another hyprlock daemon running?", m_szSocketPath);
+        close(m_iSocketFD);
+        m_iSocketFD = -1;
+        return false;
+    }
+
+    unlink(m_szSocketPath.c_str());
+
+    if (bind(m_iSocketFD, (sockaddr*)&addr, SUN_LEN(&addr)) != 0 || listen(m_iSocketFD, 8) != 0) {
+        Debug::log(ERR, "[socket] Failed to bind {}: {}", m_szSocketPath, errno);
+        close(m_iSocketFD);
+        m_iSocketFD = -1;
+        return false;
+    }
+
+    g_pHyprlock->m_pEventLoop->addFd(m_iSocketFD, EPOLLIN, [this](uint32_t) { onAccept(); }, "socket");
+
+    Debug::log(LOG, "[socket] Listening on {}", m_szSocketPath);
+    return true;
+}
+
+void CControlSocket::registerCommand(const std::string& name, CommandHandler handler) {
+    m_mCommands[name] = handler;
+}
+
+void CControlSocket::onAccept() {
+    while (true) {
+        const int CLIENTFD = accept4(m_iSocketFD, nullptr, nullptr, SOCK_CLOEXEC | SOCK_NONBLOCK);
+        if (CLIENTFD < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK)
+                Debug::log(ERR, "[socket] accept failed: {}", errno);
+            return;
+        }
+
+        m_mClients[CLIENTFD] = "";
+        g_pHyprlock->m_pEventLoop->addFd(CLIENTFD, EPOLLIN, [this, CLIENTFD](uint32_t) { onClientData(CLIENTFD); }, "socket client");
+    }
+}
+
+void CControlSocket::onClientData(int fd) {
+    auto& pending = m_mClients[fd];
+
+    char  buf[512];
+    bool  eof = false;
+    while (true) {
+        const auto LEN = read(fd, buf, sizeof(buf));
+        if (LEN > 0) {
+            pending.append(buf, LEN);
+            continue;
+        }
+
+        eof = LEN == 0 || (errno != EAGAIN && errno != EWOULDBLOCK);
+        break;
+    }
+
+    const auto NEWLINE = pending.find('\n');
+    if (NEWLINE == std::string::npos && !eof) {
+        if (pending.length() > MAX_COMMAND_LENGTH)
+            closeClient(fd);
+        return;
+    }
+
+    const auto REPLY = handleCommand(pending.substr(0, NEWLINE)) + "\n";
+    // best effort, replies are short and the client is waiting for them
+    if (write(fd, REPLY.c_str(), REPLY.length()) < 0)
+        Debug::log(WARN, "[socket] Failed to reply: {}", errno);
+
+    closeClient(fd);
+}
+
+void CControlSocket::closeClient(int fd) {
+    g_pHyprlock->m_pEventLoop->removeFd(fd);
+    m_mClients.erase(fd);
+    close(fd);
+}
+
+std::string CControlSocket::handleCommand(const std::string& line) {
+    const auto SPACE   = line.find(' ');
+    const auto COMMAND = line.substr(0, SPACE);
+    const auto ARGS    = SPACE == std::string::npos ? "" : line.substr(SPACE + 1);
+
+    const auto IT = m_mCommands.find(COMMAND);
+    if (IT == m_mCommands.end()) {
+        Debug::log(WARN, "[socket] Unknown command \"{}\"", COMMAND);
+        return "error: unknown command";
+    }
+
+    Debug::log(LOG, "[socket] Command \"{}\"", line);
+    return IT->second(ARGS);
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <functional>
+#include <string>
+#include <unordered_map>
+
+// Unix socket in $XDG_RUNTIME_DIR taking one command per connection, e.g.
+// `echo lock | socat - UNIX-CONNECT:$XDG_RUNTIME_DIR/hyprlock.sock`.
+// Runs on the event loop, handlers are called on the main thread. The connection is closed after the reply,
+// which may span multiple lines.
+class CControlSocket {
+  public:
+    CControlSocket();
+    ~CControlSocket();
+
+    // The returned string is sent back to the client
+    typedef std::function<std::string(const std::string& args)> CommandHandler;
+
+    bool start();
+    void registerCommand(const std::string& name, CommandHandler handler);
+
+  private:
+    void                                            onAccept();
+    void                                            onClientData(int fd);
+    void                                            closeClient(int fd);
+    std::string                                     handleCommand(const std::string& line);
+
+    int                                             m_iSocketFD = -1;
+    std::string                                     m_szSocketPath;
+
+    std::unordered_map<std::string, CommandHandler> m_mCommands;
+    // partially read commands
+    std::unordered_map<int, std::string>            m_mClients;
+};
@@ -0,0 +1,203 @@
+#include "DataProviders.hpp"
+#include "hyprlock.hpp"
+#include "Auth.hpp"
+#include "Fingerprint.hpp"
+#include "../helpers/Log.hpp"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <unistd.h>
+#include <limits.h>
+
+static std::string readFirstLine(const std::filesystem::path& path) {
+    std::ifstream file(path);
+    std::string   line;
+    std::getline(file, line);
+    return line;
+}
+
+static std::string readHostname() {
+    char buf[HOST_NAME_MAX + 1] = {0};
+    if (gethostname(buf, sizeof(buf) - 1) != 0)
+        return "";
+
+    return buf;
+}
+
+// e.g. "3d 4h 12m", leading zero units are left out
+static std::string readUptime() {
+    const auto LINE = readFirstLine("/proc/uptime");
+    if (LINE.empty())
+        return "";
+
+    uint64_t seconds = 0;
+    try {
+        seconds = std::stoull(LINE);
+    } catch (std::exception& e) { return ""; }
+
+    const auto  DAYS  = seconds / 86400;
+    const auto  HOURS = seconds % 86400 / 3600;
+    const auto  MINS  = seconds % 3600 / 60;
+
+    std::string result;
+    if (DAYS > 0)
+        result += std::to_string(DAYS) + "d ";
+    if (DAYS > 0 || HOURS > 0)
+        result += std::to_string(HOURS) + "h ";
+    result += std::to_string(MINS) + "m";
+
+    return result;
+}
+
+// charge in percent, averaged over all batteries. Empty without one.
+static std::string readBattery() {
+    std::error_code ec;
+    uint64_t        total = 0;
+    uint64_t        count = 0;
+
+    for (const auto& entry : std::filesystem::directory_iterator("/sys/class/power_supply", ec)) {
+        if (readFirstLine(entry.path() / "type") != "Battery")
+            continue;
+
+        try {
+            total += std::stoull(readFirstLine(entry.path() / "capacity"));
+            count++;
+        } catch (std::exception& e) { continue; }
+    }
+
+    if (count == 0)
+        return "";
+
+    return std::to_string(total / count);
+}
+
+CDataProviders::CDataProviders() {
+    registerProvider("HOSTNAME", READ_ONCE, readHostname);
+    registerProvider("UPTIME", std::chrono::seconds(15), readUptime);
+    registerProvider("BATTERY", std::chrono::seconds(30), readBattery);
+
+    // auth state, updated through CHyprlock::enqueueVariableUpdate. Auth and fingerprint only exist while locked.
+    registerProvider("FAIL", UPDATE_ONLY, []() { return g_pAuth ? g_pAuth->getLastFailText().value_or("") : ""; });
+    registerProvider("PROMPT", UPDATE_ONLY, []() { return g_pAuth ? g_pAuth->getLastPrompt().value_or("") : ""; });
+    registerProvider("FPRINTMESSAGE", UPDATE_ONLY, []() { return g_pFingerprint ? g_pFingerprint->getLastMessage().value_or("") : ""; });
+    // these two have their own syntax in IWidget::formatString, the value is only used to notice a change
+    registerProvider("ATTEMPTS", UPDATE_ONLY, []() { return std::to_string(g_pHyprlock->getPasswordFailedAttempts()); });
+    registerProvider("LAYOUT", UPDATE_ONLY, []() { return std::to_string(g_pHyprlock->m_uiActiveLayout); });
+}
+
+CDataProviders::~CDataProviders() {
+    for (auto& p : m_vProviders) {
+        if (p->timer)
+            p->timer->cancel();
+    }
+}
+
+void CDataProviders::registerProvider(const std::string& name, std::chrono::steady_clock::duration pollInterval, ReadFn read) {
+    auto provider          = std::make_unique<SProvider>();
+    provider->name         = name;
+    provider->pollInterval = pollInterval;
+    provider->read         = read;
+
+    // longer names first, so $BATTERY_TIME would not be taken for $BATTERY
+    m_vProviders.push_back(std::move(provider));
+    std::ranges::stable_sort(m_vProviders, [](const auto& a, const auto& b) { return a->name.length() > b->name.length(); });
+}
+
+CDataProviders::SProvider* CDataProviders::find(const std::string& name) {
+    const auto IT = std::ranges::find_if(m_vProviders, [&name](const auto& p) { return p->name == name; });
+    return IT == m_vProviders.end() ? nullptr : IT->get();
+}
+
+std::string CDataProviders::get(const std::string& name) {
+    const auto PPROVIDER = find(name);
+    if (!PPROVIDER)
+        return "";
+
+    if (!PPROVIDER->valid) {
+        PPROVIDER->value = PPROVIDER->read();
+        PPROVIDER->valid = true;
+    }
+
+    return PPROVIDER->value;
+}
+
+std::vector<std::string> CDataProviders::usedBy(const std::string& str) {
+    std::vector<std::string> result;
+    if (!str.contains('$'))
+        return result;
+
+    for (const auto& p : m_vProviders) {
+        if (str.contains("$" + p->name))
+            result.push_back(p->name);
+    }
+
+    return result;
+}
+
+void CDataProviders::subscribe(const std::string& name, void* owner, std::function<void()> onChange) {
+    const auto PPROVIDER = find(name);
+    if (!PPROVIDER)
+        return;
+
+    PPROVIDER->subscribers.push_back({owner, onChange});
+
+    if (PPROVIDER->timer || PPROVIDER->pollInterval == READ_ONCE || PPROVIDER->pollInterval == UPDATE_ONLY)
+        return;
+
+    PPROVIDER->timer = g_pHyprlock->addTimer(
+        PPROVIDER->pollInterval,
+        [this, PPROVIDER](std::shared_ptr<CTimer> self, void* data) {
+            poll(*PPROVIDER);
+            g_pHyprlock->rearmTimer(self, PPROVIDER->pollInterval);
+        },
+        nullptr, false, PPROVIDER->pollInterval / 10);
+}
+
+void CDataProviders::unsubscribe(void* owner) {
+    for (auto& p : m_vProviders) {
+        std::erase_if(p->subscribers, [owner](const auto& s) { return s.owner == owner; });
+
+        if (!p->subscribers.empty())
+            continue;
+
+        // nobody to tell, stop polling. The next get() reads it again.
+        if (p->timer) {
+            p->timer->cancel();
+            p->timer.reset();
+        }
+
+        if (p->pollInterval != READ_ONCE)
+            p->valid = false;
+    }
+}
+
+void CDataProviders::update(const std::string& name) {
+    const auto PPROVIDER = find(name);
+    if (!PPROVIDER)
+        return;
+
+    // nobody to tell, get() reads it when it's needed
+    if (PPROVIDER->subscribers.empty()) {
+        PPROVIDER->valid = false;
+        return;
+    }
+
+    poll(*PPROVIDER);
+}
+
+void CDataProviders::poll(SProvider& provider) {
+    auto value = provider.read();
+    if (provider.valid && value == provider.value)
+        return;
+
+    Debug::log(TRACE, "[providers] ${} changed to \"{}\"", provider.name, value);
+
+    provider.value = std::move(value);
+    provider.valid = true;
+
+    // copy, a subscriber may unsubscribe
+    const auto SUBSCRIBERS = provider.subscribers;
+    for (const auto& s : SUBSCRIBERS) {
+        s.onChange();
+    }
+}
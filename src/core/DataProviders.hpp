@@ -0,0 +1,62 @@
+#pragma once
+
+#include "Timer.hpp"
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Values for label variables like $BATTERY or $FAIL, read in-process instead of through cmd[].
+// A provider is read once when first asked for and then polled, or updated by its owner, while something is subscribed to it.
+// Subscribers are only called when the value actually changed. Main thread only.
+class CDataProviders {
+  public:
+    CDataProviders();
+    ~CDataProviders();
+
+    typedef std::function<std::string()> ReadFn;
+
+    // for values that never change
+    static constexpr std::chrono::steady_clock::duration READ_ONCE = std::chrono::steady_clock::duration::zero();
+    // never polled, whoever changes it calls update()
+    static constexpr std::chrono::steady_clock::duration UPDATE_ONLY = std::chrono::steady_clock::duration::max();
+
+    // name is the variable without the $
+    void                     registerProvider(const std::string& name, std::chrono::steady_clock::duration pollInterval, ReadFn read);
+    // reads it again and tells subscribers if it changed
+    void                     update(const std::string& name);
+
+    // the cached value
+    std::string              get(const std::string& name);
+    // names of the providers used in str
+    std::vector<std::string> usedBy(const std::string& str);
+
+    void                     subscribe(const std::string& name, void* owner, std::function<void()> onChange);
+    void                     unsubscribe(void* owner);
+
+  private:
+    struct SSubscriber {
+        void*                 owner = nullptr;
+        std::function<void()> onChange;
+    };
+
+    struct SProvider {
+        std::string                         name;
+        std::chrono::steady_clock::duration pollInterval;
+        ReadFn                              read;
+
+        std::string                         value;
+        bool                                valid = false;
+
+        std::shared_ptr<CTimer>             timer;
+        std::vector<SSubscriber>            subscribers;
+    };
+
+    SProvider*                              find(const std::string& name);
+    void                                    poll(SProvider& provider);
+
+    std::vector<std::unique_ptr<SProvider>> m_vProviders;
+};
+
+inline std::unique_ptr<CDataProviders> g_pDataProviders;
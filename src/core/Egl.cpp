@@ -65,6 +65,20 @@ CEGL::CEGL(wl_display* display) {
         goto error;
     }
 
+    {
+        const char*       _DPYEXTS = eglQueryString(eglDisplay, EGL_EXTENSIONS);
+        const std::string DPYEXTS  = _DPYEXTS ? _DPYEXTS : "";
+
+        bufferAge = DPYEXTS.contains("EGL_EXT_buffer_age");
+
+        if (DPYEXTS.contains("EGL_KHR_swap_buffers_with_damage"))
+            eglSwapBuffersWithDamage = (PFNEGLSWAPBUFFERSWITHDAMAGEKHRPROC)eglGetProcAddress("eglSwapBuffersWithDamageKHR");
+        else if (DPYEXTS.contains("EGL_EXT_swap_buffers_with_damage"))
+            eglSwapBuffersWithDamage = (PFNEGLSWAPBUFFERSWITHDAMAGEKHRPROC)eglGetProcAddress("eglSwapBuffersWithDamageEXT");
+
+        Debug::log(LOG, "EGL buffer age {}, swap with damage {}", bufferAge ? "supported" : "unsupported", eglSwapBuffersWithDamage ? "supported" : "unsupported");
+    }
+
     return;
 
 error:
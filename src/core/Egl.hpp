@@ -16,6 +16,10 @@ class CEGL {
     EGLContext                               eglContext;
 
     PFNEGLCREATEPLATFORMWINDOWSURFACEEXTPROC eglCreatePlatformWindowSurfaceEXT;
+    // EGL_KHR_swap_buffers_with_damage or the EXT one, nullptr if neither is supported
+    PFNEGLSWAPBUFFERSWITHDAMAGEKHRPROC       eglSwapBuffersWithDamage = nullptr;
+    // EGL_EXT_buffer_age, back buffers keep what was drawn to them and only changes need to be redrawn
+    bool                                     bufferAge = false;
 
     void                                     makeCurrent(EGLSurface surf);
 };
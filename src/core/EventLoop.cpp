@@ -0,0 +1,206 @@
+#include "EventLoop.hpp"
+#include "../helpers/Log.hpp"
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+#include <errno.h>
+#include <algorithm>
+#include <limits>
+
+CEventLoop::CEventLoop() {
+    m_iEpollFD = epoll_create1(EPOLL_CLOEXEC);
+    m_iTimerFD = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC | TFD_NONBLOCK);
+    m_iWakeFD  = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+
+    if (m_iEpollFD < 0 || m_iTimerFD < 0 || m_iWakeFD < 0) {
+        Debug::log(CRIT, "[eventloop] Failed to create the epoll, timer or event fd: {}", errno);
+        exit(1);
+    }
+
+    m_vReady.resize(16);
+
+    addFd(
+        m_iTimerFD, EPOLLIN,
+        [this](uint32_t) {
+            uint64_t expirations = 0;
+            read(m_iTimerFD, &expirations, sizeof(expirations));
+            // one-shot, it is disarmed now
+            m_tArmedDeadline.reset();
+        },
+        "timer");
+
+    addFd(
+        m_iWakeFD, EPOLLIN,
+        [this](uint32_t) {
+            uint64_t count = 0;
+            read(m_iWakeFD, &count, sizeof(count));
+
+            if (m_bDumpRequested.exchange(false))
+                dumpWakeups();
+        },
+        "eventfd");
+
+    // not fatal, labels just don't resync until their next tick
+    m_iClockFD = timerfd_create(CLOCK_REALTIME, TFD_CLOEXEC | TFD_NONBLOCK);
+    if (m_iClockFD < 0) {
+        Debug::log(WARN, "[eventloop] Failed to create the clock change timerfd: {}", errno);
+        return;
+    }
+
+    armClockWatch();
+
+    addFd(
+        m_iClockFD, EPOLLIN,
+        [this](uint32_t) {
+            uint64_t expirations = 0;
+            if (read(m_iClockFD, &expirations, sizeof(expirations)) >= 0 || errno != ECANCELED)
+                return;
+
+            Debug::log(LOG, "[eventloop] Wall clock changed");
+
+            // cancel-on-set is one-shot as well
+            armClockWatch();
+
+            if (m_clockChangedCallback)
+                m_clockChangedCallback();
+        },
+        "clock");
+}
+
+void CEventLoop::armClockWatch() {
+    // Never expires on its own, it is only there to be cancelled on a clock change
+    itimerspec spec      = {};
+    spec.it_value.tv_sec = std::numeric_limits<time_t>::max();
+
+    if (timerfd_settime(m_iClockFD, TFD_TIMER_ABSTIME | TFD_TIMER_CANCEL_ON_SET, &spec, nullptr) != 0)
+        Debug::log(WARN, "[eventloop] Failed to arm the clock change timerfd: {}", errno);
+}
+
+void CEventLoop::setClockChangedCallback(std::function<void()> cb) {
+    m_clockChangedCallback = cb;
+}
+
+CEventLoop::~CEventLoop() {
+    if (m_iClockFD >= 0)
+        close(m_iClockFD);
+    close(m_iWakeFD);
+    close(m_iTimerFD);
+    close(m_iEpollFD);
+}
+
+bool CEventLoop::addFd(int fd, uint32_t events, FdCallback cb, const std::string& name) {
+    epoll_event ev = {
+        .events = events,
+        .data   = {.fd = fd},
+    };
+
+    if (epoll_ctl(m_iEpollFD, EPOLL_CTL_ADD, fd, &ev) != 0) {
+        Debug::log(ERR, "[eventloop] Failed to add fd {}: {}", fd, errno);
+        return false;
+    }
+
+    m_mSources[fd] = SSource{cb, name};
+    return true;
+}
+
+void CEventLoop::removeFd(int fd) {
+    epoll_ctl(m_iEpollFD, EPOLL_CTL_DEL, fd, nullptr);
+    m_mSources.erase(fd);
+
+    // don't run a callback for an fd that is gone
+    for (size_t i = 0; i < m_iReadyCount; ++i) {
+        if (m_vReady[i].data.fd == fd)
+            m_vReady[i].events = 0;
+    }
+}
+
+void CEventLoop::wakeup(eWakeupSource source) {
+    m_aWakeupRequests[source].fetch_add(1, std::memory_order_relaxed);
+
+    const uint64_t one = 1;
+    write(m_iWakeFD, &one, sizeof(one));
+}
+
+void CEventLoop::requestWakeupDump() {
+    m_bDumpRequested = true;
+    wakeup(WAKEUP_SIGNAL);
+}
+
+std::string CEventLoop::wakeupStats() {
+    std::string perSource;
+    for (const auto& [fd, source] : m_mSources) {
+        perSource += std::format("{}{}: {}", perSource.empty() ? "" : ", ", source.name, source.wakeups);
+    }
+
+    return std::format("{} wakeups ({}), eventfd requests: tasks: {}, gatherer: {}, signals: {}", m_iWakeups, perSource, m_aWakeupRequests[WAKEUP_TASK].load(),
+                       m_aWakeupRequests[WAKEUP_GATHERER].load(), m_aWakeupRequests[WAKEUP_SIGNAL].load());
+}
+
+void CEventLoop::dumpWakeups() {
+    Debug::log(LOG, "[eventloop] {}", wakeupStats());
+}
+
+void CEventLoop::armTimer(const std::optional<std::chrono::steady_clock::time_point>& deadline) {
+    if (deadline == m_tArmedDeadline)
+        return;
+
+    m_tArmedDeadline = deadline;
+
+    itimerspec spec = {};
+
+    if (deadline.has_value()) {
+        // steady_clock is CLOCK_MONOTONIC. A zero it_value would disarm, fire asap instead
+        const auto NS         = std::max<int64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(deadline->time_since_epoch()).count(), 1);
+        spec.it_value.tv_sec  = NS / 1000000000L;
+        spec.it_value.tv_nsec = NS % 1000000000L;
+    }
+
+    timerfd_settime(m_iTimerFD, TFD_TIMER_ABSTIME, &spec, nullptr);
+}
+
+int CEventLoop::wait() {
+    m_iReadyCount = 0;
+
+    int ret = 0;
+    do {
+        ret = epoll_wait(m_iEpollFD, m_vReady.data(), m_vReady.size(), -1);
+    } while (ret < 0 && errno == EINTR);
+
+    if (ret < 0) {
+        Debug::log(CRIT, "[eventloop] epoll_wait failed with {}", errno);
+        return -1;
+    }
+
+    m_iReadyCount = ret;
+    m_iWakeups++;
+    return ret;
+}
+
+bool CEventLoop::isReady(int fd) {
+    for (size_t i = 0; i < m_iReadyCount; ++i) {
+        if (m_vReady[i].data.fd == fd)
+            return m_vReady[i].events & EPOLLIN;
+    }
+
+    return false;
+}
+
+void CEventLoop::dispatch() {
+    for (size_t i = 0; i < m_iReadyCount; ++i) {
+        const auto EVENTS = m_vReady[i].events;
+        if (EVENTS == 0)
+            continue;
+
+        const auto IT = m_mSources.find(m_vReady[i].data.fd);
+        if (IT == m_mSources.end())
+            continue;
+
+        IT->second.wakeups++;
+
+        // copy, the callback may remove itself
+        const auto CB = IT->second.cb;
+        CB(EVENTS);
+    }
+
+    m_iReadyCount = 0;
+}
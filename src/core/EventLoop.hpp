@@ -0,0 +1,79 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <string>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+#include <sys/epoll.h>
+
+// Single-threaded epoll reactor. Owns a timerfd for the nearest timer deadline and an eventfd
+// other threads (and signal handlers) can use to interrupt a blocking wait.
+// A second, realtime timerfd reports wall clock jumps (settimeofday, resume from suspend).
+class CEventLoop {
+  public:
+    CEventLoop();
+    ~CEventLoop();
+
+    typedef std::function<void(uint32_t events)> FdCallback;
+
+    // who asked for a wakeup through the eventfd, for accounting
+    enum eWakeupSource : uint8_t {
+        WAKEUP_TASK = 0,
+        WAKEUP_GATHERER,
+        WAKEUP_SIGNAL,
+        WAKEUP_SOURCE_COUNT,
+    };
+
+    // name is used for wakeup accounting
+    bool addFd(int fd, uint32_t events, FdCallback cb, const std::string& name);
+    void removeFd(int fd);
+
+    // Async-signal-safe, may be called from any thread.
+    void wakeup(eWakeupSource source = WAKEUP_TASK);
+
+    // Async-signal-safe. Logs the wakeup counters from the loop thread.
+    void        requestWakeupDump();
+    void        dumpWakeups();
+    std::string wakeupStats();
+
+    // Arms the timerfd to an absolute deadline. std::nullopt disarms it.
+    void armTimer(const std::optional<std::chrono::steady_clock::time_point>& deadline);
+
+    // Called from the loop whenever the wall clock jumps, monotonic deadlines stay valid but wall clock aligned ones don't.
+    void setClockChangedCallback(std::function<void()> cb);
+
+    // Blocks until at least one fd is ready. Returns the amount of ready fds or -1 on error.
+    int  wait();
+    bool isReady(int fd);
+    // Runs the callbacks of the fds reported by the last wait().
+    void dispatch();
+
+  private:
+    struct SSource {
+        FdCallback  cb;
+        std::string name;
+        uint64_t    wakeups = 0;
+    };
+
+    void                                                   armClockWatch();
+
+    int                                                    m_iEpollFD = -1;
+    int                                                    m_iTimerFD = -1;
+    int                                                    m_iWakeFD  = -1;
+    int                                                    m_iClockFD = -1;
+
+    std::unordered_map<int, SSource>                       m_mSources;
+    std::vector<epoll_event>                               m_vReady;
+    size_t                                                 m_iReadyCount = 0;
+
+    std::optional<std::chrono::steady_clock::time_point>   m_tArmedDeadline;
+    std::function<void()>                                  m_clockChangedCallback;
+
+    uint64_t                                               m_iWakeups = 0;
+    std::array<std::atomic<uint64_t>, WAKEUP_SOURCE_COUNT> m_aWakeupRequests = {};
+    std::atomic<bool>                                      m_bDumpRequested  = false;
+};
@@ -131,7 +131,7 @@ bool CFingerprint::createDeviceProxy() {
                 if (!isPresent)
                     return;
                 m_sDBUSState.message = m_sFingerprintPresent;
-                g_pHyprlock->enqueueForceUpdateTimers();
+                g_pHyprlock->enqueueVariableUpdate("FPRINTMESSAGE");
             } catch (std::out_of_range& e) {}
         });
 
@@ -173,7 +173,7 @@ void CFingerprint::handleVerifyStatus(const std::string& result, bool done) {
             m_sDBUSState.abort   = true;
             break;
     }
-    g_pHyprlock->enqueueForceUpdateTimers();
+    g_pHyprlock->enqueueVariableUpdate("FPRINTMESSAGE");
     if (done || m_sDBUSState.abort)
         m_sDBUSState.done = true;
 }
@@ -212,7 +212,7 @@ void CFingerprint::startVerify(bool isRetry) {
             } else
                 m_sDBUSState.message = m_sFingerprintReady;
         }
-        g_pHyprlock->enqueueForceUpdateTimers();
+        g_pHyprlock->enqueueVariableUpdate("FPRINTMESSAGE");
     });
 }
 
@@ -35,6 +35,13 @@ CSessionLockSurface::~CSessionLockSurface() {
         wp_fractional_scale_v1_destroy(fractional);
     }
 
+    // the daemon destroys its surfaces on every unlock
+    if (g_pRenderer)
+        g_pRenderer->removeWidgetsFor(this);
+
+    if (eglSurface && g_pEGL)
+        eglDestroySurface(g_pEGL->eglDisplay, eglSurface);
+
     if (eglWindow)
         wl_egl_window_destroy(eglWindow);
 
@@ -159,18 +166,32 @@ static const wl_callback_listener callbackListener = {
 };
 
 void CSessionLockSurface::render() {
-    Debug::log(TRACE, "render lock");
+    needsFrame = true;
+}
 
-    if (frameCallback || !readyForFrame) {
-        needsFrame = true;
+void CSessionLockSurface::renderIfNeeded() {
+    if (!needsFrame || frameCallback || !readyForFrame)
         return;
-    }
+
+    Debug::log(TRACE, "render lock");
 
     const auto FEEDBACK = g_pRenderer->renderLock(*this);
     frameCallback       = wl_surface_frame(surface);
     wl_callback_add_listener(frameCallback, &callbackListener, this);
 
-    eglSwapBuffers(g_pEGL->eglDisplay, eglSurface);
+    if (g_pEGL->eglSwapBuffersWithDamage && !FEEDBACK.fullDamage) {
+        std::vector<EGLint> rects;
+        for (const auto& box : FEEDBACK.damage) {
+            rects.insert(rects.end(), {(EGLint)box.x, (EGLint)box.y, (EGLint)box.width, (EGLint)box.height});
+        }
+
+        // no rects would damage everything
+        if (rects.empty())
+            rects = {0, 0, 0, 0};
+
+        g_pEGL->eglSwapBuffersWithDamage(g_pEGL->eglDisplay, eglSurface, rects.data(), rects.size() / 4);
+    } else
+        eglSwapBuffers(g_pEGL->eglDisplay, eglSurface);
 
     needsFrame = FEEDBACK.needsFrame;
 }
@@ -179,8 +200,5 @@ void CSessionLockSurface::onCallback() {
     wl_callback_destroy(frameCallback);
     frameCallback = nullptr;
 
-    if (needsFrame && !g_pHyprlock->m_bTerminate && g_pEGL) {
-        needsFrame = false;
-        render();
-    }
-}
\ No newline at end of file
+    // a pending frame gets rendered at the end of this loop iteration
+}
@@ -22,7 +22,10 @@ class CSessionLockSurface {
 
     float fractionalScale = 1.0;
 
+    // Only requests a frame, see renderIfNeeded
     void  render();
+    // Renders if a frame was requested and the last one was presented. Called once per loop iteration
+    void  renderIfNeeded();
     void  onCallback();
     void  onScaleUpdate();
 
@@ -0,0 +1,396 @@
+#include "ProcessExecutor.hpp"
+#include "hyprlock.hpp"
+#include "../helpers/Log.hpp"
+#include "../config/ConfigManager.hpp"
+#include <spawn.h>
+#include <signal.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+
+extern char** environ;
+
+// commands beyond this wait until one finishes
+constexpr size_t MAX_RUNNING = 4;
+// nothing shown on a lockscreen needs more, the rest is dropped
+constexpr size_t MAX_OUTPUT = 1024 * 1024;
+// without pidfds, how often a child that closed stdout is checked for having exited
+constexpr auto REAP_POLL_INTERVAL = std::chrono::milliseconds(50);
+
+CProcessExecutor::CProcessExecutor() = default;
+
+CProcessExecutor::~CProcessExecutor() {
+    for (auto& [id, job] : m_mRunning) {
+        if (job->timeoutTimer)
+            job->timeoutTimer->cancel();
+        if (job->reapTimer)
+            job->reapTimer->cancel();
+
+        kill(*job);
+        closeFds(*job);
+        reap(*job, true);
+    }
+}
+
+uint64_t CProcessExecutor::execute(const std::string& cmd, Callback cb, std::chrono::steady_clock::duration timeout) {
+    static auto* const PTIMEOUT = (Hyprlang::INT* const*)g_pConfigManager->getValuePtr("general:command_timeout");
+
+    auto               job = std::make_unique<SJob>();
+    job->id                = m_iNextID++;
+    job->cmd               = cmd;
+    job->cb                = std::move(cb);
+    job->timeout           = timeout.count() > 0 ? timeout : std::chrono::milliseconds(**PTIMEOUT);
+
+    const auto ID = job->id;
+    m_dQueued.push_back(std::move(job));
+    startQueued();
+
+    return ID;
+}
+
+uint64_t CProcessExecutor::executeShared(const std::string& cmd, std::chrono::steady_clock::duration maxAge, Callback cb, std::chrono::steady_clock::duration timeout) {
+    const auto NOW = std::chrono::steady_clock::now();
+
+    // forget results nobody asked for in a while
+    std::erase_if(m_mShared, [NOW](const auto& e) { return e.second.jobID == 0 && e.second.waiters.empty() && NOW - e.second.started >= e.second.maxAge; });
+
+    const auto KEY   = cmd + "\n" + std::to_string(std::chrono::duration_cast<std::chrono::milliseconds>(maxAge).count());
+    auto&      entry = m_mShared[KEY];
+    entry.maxAge     = maxAge;
+
+    const auto ID        = m_iNextID++;
+    m_mSharedWaiters[ID] = std::move(cb);
+    entry.waiters.push_back(ID);
+
+    if (entry.jobID != 0)
+        return ID;
+
+    if (entry.valid && NOW - entry.started < maxAge) {
+        Debug::log(TRACE, "[exec] Reusing the result of \"{}\"", cmd);
+        // after returning, like a real run. Unless a new run started in the meantime, then that one is awaited.
+        g_pHyprlock->addTask([this, KEY]() {
+            if (m_mShared[KEY].jobID == 0)
+                deliverShared(KEY);
+        });
+        return ID;
+    }
+
+    entry.cmd     = cmd;
+    entry.timeout = timeout;
+    startShared(KEY);
+
+    return ID;
+}
+
+void CProcessExecutor::startShared(const std::string& key) {
+    auto& entry   = m_mShared[key];
+    entry.started = std::chrono::steady_clock::now();
+    entry.restart = false;
+    entry.jobID   = execute(
+        entry.cmd,
+        [this, key](const SResult& result) {
+            auto& entry = m_mShared[key];
+            entry.jobID = 0;
+
+            // invalidated while running, the output may be from before the change
+            if (entry.restart) {
+                startShared(key);
+                return;
+            }
+
+            // retry a timed out one next time instead of showing nothing for a while
+            entry.valid  = !result.timedOut;
+            entry.result = result;
+            deliverShared(key);
+        },
+        entry.timeout);
+}
+
+void CProcessExecutor::invalidateShared(const std::string& cmd) {
+    for (auto& [key, entry] : m_mShared) {
+        if (entry.cmd != cmd)
+            continue;
+
+        entry.valid = false;
+        if (entry.jobID != 0)
+            entry.restart = true;
+    }
+}
+
+void CProcessExecutor::deliverShared(const std::string& key) {
+    const auto IT = m_mShared.find(key);
+    if (IT == m_mShared.end())
+        return;
+
+    // copies, callbacks may ask for the same command again
+    const auto RESULT  = IT->second.result;
+    const auto WAITERS = std::move(IT->second.waiters);
+    IT->second.waiters.clear();
+
+    for (const auto& id : WAITERS) {
+        const auto WAITER = m_mSharedWaiters.find(id);
+        if (WAITER == m_mSharedWaiters.end())
+            continue;
+
+        const auto CB = std::move(WAITER->second);
+        m_mSharedWaiters.erase(WAITER);
+
+        if (CB)
+            CB(RESULT);
+    }
+}
+
+void CProcessExecutor::cancel(uint64_t id) {
+    if (m_mSharedWaiters.erase(id) > 0)
+        return;
+
+    if (std::erase_if(m_dQueued, [id](const auto& job) { return job->id == id; }) > 0)
+        return;
+
+    const auto IT = m_mRunning.find(id);
+    if (IT == m_mRunning.end())
+        return;
+
+    Debug::log(TRACE, "[exec] Cancelling \"{}\"", IT->second->cmd);
+
+    // the pidfd keeps reporting the exit, so the job stays until it is reaped, just without a callback
+    IT->second->cb = nullptr;
+    kill(*IT->second);
+}
+
+void CProcessExecutor::startQueued() {
+    while (!m_dQueued.empty() && m_mRunning.size() < MAX_RUNNING) {
+        auto job = std::move(m_dQueued.front());
+        m_dQueued.pop_front();
+
+        // report a failure later, callers expect the callback after execute() returned and may still cancel it
+        if (!spawn(*job)) {
+            job->exited = true;
+            job->eof    = true;
+            g_pHyprlock->addTask([this, ID = job->id]() { finish(ID); });
+        }
+
+        m_mRunning[job->id] = std::move(job);
+    }
+}
+
+bool CProcessExecutor::spawn(SJob& job) {
+    Debug::log(LOG, "Executing (async) {}", job.cmd);
+
+    int pipeFDs[2];
+    if (pipe2(pipeFDs, O_CLOEXEC | O_NONBLOCK) != 0) {
+        Debug::log(ERR, "[exec] Failed to create a pipe for \"{}\": {}", job.cmd, errno);
+        return false;
+    }
+
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_addopen(&actions, STDIN_FILENO, "/dev/null", O_RDONLY, 0);
+    posix_spawn_file_actions_adddup2(&actions, pipeFDs[1], STDOUT_FILENO);
+
+    // own process group, so a timeout kills whatever the shell started too.
+    // hyprlock blocks and handles some signals, don't pass that on.
+    posix_spawnattr_t attr;
+    posix_spawnattr_init(&attr);
+    posix_spawnattr_setflags(&attr, POSIX_SPAWN_SETPGROUP | POSIX_SPAWN_SETSIGMASK | POSIX_SPAWN_SETSIGDEF);
+    posix_spawnattr_setpgroup(&attr, 0);
+
+    sigset_t set;
+    sigemptyset(&set);
+    posix_spawnattr_setsigmask(&attr, &set);
+    sigfillset(&set);
+    posix_spawnattr_setsigdefault(&attr, &set);
+
+    const char* argv[] = {"/bin/sh", "-c", job.cmd.c_str(), nullptr};
+    const int   RET    = posix_spawn(&job.pid, "/bin/sh", &actions, &attr, (char* const*)argv, environ);
+
+    posix_spawnattr_destroy(&attr);
+    posix_spawn_file_actions_destroy(&actions);
+    close(pipeFDs[1]);
+
+    if (RET != 0) {
+        Debug::log(ERR, "[exec] Failed to spawn \"{}\": {}", job.cmd, RET);
+        close(pipeFDs[0]);
+        job.pid = -1;
+        return false;
+    }
+
+    Debug::log(LOG, "Process Created with pid {}", job.pid);
+
+    const auto ID = job.id;
+    job.stdoutFD  = pipeFDs[0];
+    g_pHyprlock->m_pEventLoop->addFd(job.stdoutFD, EPOLLIN, [this, ID](uint32_t) { onStdout(ID); }, "exec");
+
+    // without pidfds (linux < 5.3) the child is polled for once it closes stdout
+    job.pidFD = syscall(SYS_pidfd_open, job.pid, 0);
+    if (job.pidFD >= 0) {
+        fcntl(job.pidFD, F_SETFD, FD_CLOEXEC);
+        g_pHyprlock->m_pEventLoop->addFd(job.pidFD, EPOLLIN, [this, ID](uint32_t) { onExit(ID); }, "exec");
+    }
+
+    if (job.timeout.count() > 0)
+        job.timeoutTimer = g_pHyprlock->addTimer(job.timeout, [this, ID](std::shared_ptr<CTimer> self, void* data) { onTimeout(ID); }, nullptr);
+
+    return true;
+}
+
+void CProcessExecutor::onStdout(uint64_t id) {
+    const auto IT = m_mRunning.find(id);
+    if (IT == m_mRunning.end())
+        return;
+
+    auto& job = *IT->second;
+
+    char  buf[4096];
+    while (true) {
+        const auto LEN = read(job.stdoutFD, buf, sizeof(buf));
+        if (LEN > 0) {
+            if (job.result.output.length() < MAX_OUTPUT)
+                job.result.output.append(buf, std::min<size_t>(LEN, MAX_OUTPUT - job.result.output.length()));
+            continue;
+        }
+
+        if (LEN < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+            return;
+
+        if (LEN < 0 && errno == EINTR)
+            continue;
+
+        break;
+    }
+
+    // eof, or an error which we can't do anything about either
+    g_pHyprlock->m_pEventLoop->removeFd(job.stdoutFD);
+    close(job.stdoutFD);
+    job.stdoutFD = -1;
+    job.eof      = true;
+
+    if (job.pidFD < 0)
+        pollExit(job);
+
+    if (job.exited)
+        finish(id);
+}
+
+void CProcessExecutor::onExit(uint64_t id) {
+    const auto IT = m_mRunning.find(id);
+    if (IT == m_mRunning.end())
+        return;
+
+    auto& job = *IT->second;
+    reap(job, false);
+
+    if (!job.exited) {
+        if (job.pidFD < 0)
+            pollExit(job);
+        return;
+    }
+
+    // the process is gone, but something it started may still hold stdout open.
+    // Nobody waits for the output of a cancelled one.
+    if (!job.eof && !job.result.timedOut && job.cb)
+        return;
+
+    finish(id);
+}
+
+void CProcessExecutor::onTimeout(uint64_t id) {
+    const auto IT = m_mRunning.find(id);
+    if (IT == m_mRunning.end())
+        return;
+
+    auto& job = *IT->second;
+    Debug::log(WARN, "[exec] \"{}\" timed out after {}ms, killing it", job.cmd, std::chrono::duration_cast<std::chrono::milliseconds>(job.timeout).count());
+
+    job.result.timedOut = true;
+    job.timeoutTimer.reset();
+    kill(job);
+
+    // stdout may be held open by a process that left the group, stop waiting for it
+    if (job.stdoutFD >= 0) {
+        g_pHyprlock->m_pEventLoop->removeFd(job.stdoutFD);
+        close(job.stdoutFD);
+        job.stdoutFD = -1;
+        job.eof      = true;
+    }
+
+    if (job.pidFD < 0)
+        pollExit(job);
+
+    if (job.exited)
+        finish(id);
+}
+
+void CProcessExecutor::pollExit(SJob& job) {
+    reap(job, false);
+
+    if (job.exited)
+        return;
+
+    // waitpid would block the event loop for as long as the child runs, check back on a timer instead
+    if (job.reapTimer)
+        g_pHyprlock->rearmTimer(job.reapTimer, REAP_POLL_INTERVAL);
+    else
+        job.reapTimer = g_pHyprlock->addTimer(REAP_POLL_INTERVAL, [this, ID = job.id](std::shared_ptr<CTimer> self, void* data) { onExit(ID); }, nullptr);
+}
+
+void CProcessExecutor::reap(SJob& job, bool block) {
+    if (job.exited || job.pid < 0)
+        return;
+
+    int        status = 0;
+    const auto RET    = waitpid(job.pid, &status, block ? 0 : WNOHANG);
+    if (RET == 0)
+        return;
+
+    job.exited = true;
+
+    if (RET > 0 && WIFEXITED(status))
+        job.result.exitStatus = WEXITSTATUS(status);
+}
+
+void CProcessExecutor::finish(uint64_t id) {
+    const auto IT = m_mRunning.find(id);
+    if (IT == m_mRunning.end())
+        return;
+
+    // take it out first, the callback may queue new commands
+    auto job = std::move(IT->second);
+    m_mRunning.erase(IT);
+
+    if (job->timeoutTimer)
+        job->timeoutTimer->cancel();
+
+    if (job->reapTimer)
+        job->reapTimer->cancel();
+
+    closeFds(*job);
+
+    Debug::log(TRACE, "[exec] \"{}\" finished with {}", job->cmd, job->result.exitStatus);
+
+    if (job->cb)
+        job->cb(job->result);
+
+    startQueued();
+}
+
+void CProcessExecutor::kill(SJob& job) {
+    if (job.pid > 0 && !job.exited)
+        ::kill(-job.pid, SIGKILL);
+}
+
+void CProcessExecutor::closeFds(SJob& job) {
+    if (job.stdoutFD >= 0) {
+        g_pHyprlock->m_pEventLoop->removeFd(job.stdoutFD);
+        close(job.stdoutFD);
+        job.stdoutFD = -1;
+    }
+
+    if (job.pidFD >= 0) {
+        g_pHyprlock->m_pEventLoop->removeFd(job.pidFD);
+        close(job.pidFD);
+        job.pidFD = -1;
+    }
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include "Timer.hpp"
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <sys/types.h>
+
+// Runs shell commands without blocking the caller. Commands are started with posix_spawn in their own process group,
+// stdout is read on the event loop and the result is handed to a callback on the main thread.
+// Only a few commands run at once, the rest wait in a queue. Main thread only.
+// executeShared lets widgets on different outputs share one run of the same command.
+class CProcessExecutor {
+  public:
+    CProcessExecutor();
+    virtual ~CProcessExecutor();
+
+    struct SResult {
+        std::string output;
+        int         exitStatus = -1; // -1 if it didn't exit normally
+        bool        timedOut   = false;
+    };
+
+    typedef std::function<void(const SResult& result)> Callback;
+
+    // zero timeout means general:command_timeout. Returns an id for cancel(). Virtual so tests can run the shared cache without processes.
+    virtual uint64_t execute(const std::string& cmd, Callback cb, std::chrono::steady_clock::duration timeout = std::chrono::steady_clock::duration::zero());
+    // Like execute, but a result of a run started less than maxAge ago is reused, and asking for a command that is
+    // already running waits for that run. Results are keyed on cmd and maxAge.
+    uint64_t         executeShared(const std::string& cmd, std::chrono::steady_clock::duration maxAge, Callback cb,
+                                   std::chrono::steady_clock::duration timeout = std::chrono::steady_clock::duration::zero());
+    // Drops the callback and kills the command if it is running. Shared runs keep going for the cache.
+    void             cancel(uint64_t id);
+    // The next executeShared of cmd runs it again. A run already going is started over once it is done, its waiters get the new result.
+    void             invalidateShared(const std::string& cmd);
+
+  private:
+    struct SJob {
+        uint64_t                            id = 0;
+        std::string                         cmd;
+        Callback                            cb;
+        std::chrono::steady_clock::duration timeout;
+
+        pid_t                               pid      = -1;
+        int                                 stdoutFD = -1;
+        int                                 pidFD    = -1;
+        std::shared_ptr<CTimer>             timeoutTimer;
+        std::shared_ptr<CTimer>             reapTimer; // only without a pidfd
+
+        SResult                             result;
+        bool                                eof    = false;
+        bool                                exited = false;
+    };
+
+    struct SSharedResult {
+        SResult                               result;
+        bool                                  valid = false;
+        std::chrono::steady_clock::time_point started;
+        std::chrono::steady_clock::duration   maxAge;
+        uint64_t                              jobID   = 0; // the running execution, 0 if none
+        bool                                  restart = false;
+        std::vector<uint64_t>                 waiters;
+
+        std::string                           cmd;
+        std::chrono::steady_clock::duration   timeout;
+    };
+
+    void                                                startShared(const std::string& key);
+    void                                                deliverShared(const std::string& key);
+
+    bool                                                spawn(SJob& job);
+    void                                                startQueued();
+    void                                                onStdout(uint64_t id);
+    void                                                onExit(uint64_t id);
+    void                                                onTimeout(uint64_t id);
+    void                                                pollExit(SJob& job);
+    void                                                reap(SJob& job, bool block);
+    void                                                finish(uint64_t id);
+    void                                                kill(SJob& job);
+    void                                                closeFds(SJob& job);
+
+    uint64_t                                            m_iNextID = 1;
+    std::deque<std::unique_ptr<SJob>>                   m_dQueued;
+    std::unordered_map<uint64_t, std::unique_ptr<SJob>> m_mRunning;
+
+    std::unordered_map<std::string, SSharedResult>      m_mShared;
+    std::unordered_map<uint64_t, Callback>              m_mSharedWaiters;
+};
@@ -0,0 +1,45 @@
+#include "TaskQueue.hpp"
+
+CTaskQueue::~CTaskQueue() {
+    auto task = m_pHead.exchange(nullptr, std::memory_order_acquire);
+    while (task) {
+        const auto NEXT = task->next;
+        delete task;
+        task = NEXT;
+    }
+}
+
+bool CTaskQueue::push(std::function<void()> task) {
+    auto node = new STask{std::move(task)};
+    auto head = m_pHead.load(std::memory_order_relaxed);
+
+    do {
+        node->next = head;
+    } while (!m_pHead.compare_exchange_weak(head, node, std::memory_order_release, std::memory_order_relaxed));
+
+    return head == nullptr;
+}
+
+size_t CTaskQueue::drain() {
+    // take the whole stack at once, anything pushed while we run ends up in the next batch
+    auto   task = m_pHead.exchange(nullptr, std::memory_order_acquire);
+
+    STask* ordered = nullptr;
+    while (task) {
+        const auto NEXT = task->next;
+        task->next      = ordered;
+        ordered         = task;
+        task            = NEXT;
+    }
+
+    size_t count = 0;
+    while (ordered) {
+        const auto NEXT = ordered->next;
+        ordered->fn();
+        delete ordered;
+        ordered = NEXT;
+        count++;
+    }
+
+    return count;
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <atomic>
+#include <functional>
+
+// Lock-free multi-producer single-consumer queue of closures, drained by the main thread.
+class CTaskQueue {
+  public:
+    ~CTaskQueue();
+
+    // Any thread. Returns true if the queue was empty, meaning the consumer has to be woken up.
+    bool   push(std::function<void()> task);
+
+    // Consumer only. Runs everything queued so far in push order and returns the amount of tasks ran.
+    size_t drain();
+
+  private:
+    struct STask {
+        std::function<void()> fn;
+        STask*                next = nullptr;
+    };
+
+    std::atomic<STask*> m_pHead = nullptr;
+};
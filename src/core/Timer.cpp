@@ -1,12 +1,21 @@
 #include "Timer.hpp"
 
-CTimer::CTimer(std::chrono::system_clock::duration timeout, std::function<void(std::shared_ptr<CTimer> self, void* data)> cb_, void* data_, bool force) : cb(cb_), data(data_) {
-    expires          = std::chrono::system_clock::now() + timeout;
+static std::chrono::steady_clock::time_point expiryFor(const std::chrono::steady_clock::duration& timeout) {
+    if (timeout == CTimer::FORCE_UPDATE_ONLY)
+        return std::chrono::steady_clock::time_point::max();
+
+    return std::chrono::steady_clock::now() + timeout;
+}
+
+CTimer::CTimer(std::chrono::steady_clock::duration timeout, std::function<void(std::shared_ptr<CTimer> self, void* data)> cb_, void* data_, bool force,
+               std::chrono::steady_clock::duration slack_) :
+    cb(cb_), data(data_), timerSlack(slack_) {
+    expires          = expiryFor(timeout);
     allowForceUpdate = force;
 }
 
 bool CTimer::passed() {
-    return std::chrono::system_clock::now() > expires;
+    return std::chrono::steady_clock::now() > expires;
 }
 
 void CTimer::cancel() {
@@ -22,9 +31,31 @@ void CTimer::call(std::shared_ptr<CTimer> self) {
 }
 
 float CTimer::leftMs() {
-    return std::chrono::duration_cast<std::chrono::milliseconds>(expires - std::chrono::system_clock::now()).count();
+    return std::chrono::duration_cast<std::chrono::milliseconds>(expires - std::chrono::steady_clock::now()).count();
 }
 
 bool CTimer::canForceUpdate() {
     return allowForceUpdate;
 }
+
+void CTimer::arm(const std::chrono::steady_clock::duration& timeout) {
+    expires      = expiryFor(timeout);
+    wasCancelled = false;
+    gen++;
+}
+
+void CTimer::disarm() {
+    gen++;
+}
+
+const std::chrono::steady_clock::duration& CTimer::slack() {
+    return timerSlack;
+}
+
+const std::chrono::steady_clock::time_point& CTimer::expiresAt() {
+    return expires;
+}
+
+uint64_t CTimer::generation() {
+    return gen;
+}
@@ -2,10 +2,15 @@
 
 #include <chrono>
 #include <functional>
+#include <memory>
 
 class CTimer {
   public:
-    CTimer(std::chrono::system_clock::duration timeout, std::function<void(std::shared_ptr<CTimer> self, void* data)> cb_, void* data_, bool force);
+    // a timer with this timeout never expires on its own and only fires on a force update
+    static constexpr std::chrono::steady_clock::duration FORCE_UPDATE_ONLY = std::chrono::steady_clock::duration::max();
+
+    CTimer(std::chrono::steady_clock::duration timeout, std::function<void(std::shared_ptr<CTimer> self, void* data)> cb_, void* data_, bool force,
+           std::chrono::steady_clock::duration slack_ = std::chrono::steady_clock::duration::zero());
 
     void  cancel();
     bool  passed();
@@ -16,10 +21,24 @@ class CTimer {
     bool  cancelled();
     void  call(std::shared_ptr<CTimer> self);
 
+    // Moves the deadline and un-cancels the timer. Bumps the generation so stale scheduler entries get skipped.
+    // Use CHyprlock::rearmTimer, which also reschedules it.
+    void                                         arm(const std::chrono::steady_clock::duration& timeout);
+    // Invalidates the scheduler entry without cancelling, done right before the timer fires.
+    void                                         disarm();
+    const std::chrono::steady_clock::time_point& expiresAt();
+    const std::chrono::steady_clock::duration&   slack();
+    uint64_t                                     generation();
+
+    // Fired right away when the wall clock jumps (resume from suspend, time set), see CEventLoop::setClockChangedCallback
+    bool                                         wallClockAligned = false;
+
   private:
     std::function<void(std::shared_ptr<CTimer> self, void* data)> cb;
     void*                                                         data = nullptr;
-    std::chrono::system_clock::time_point                         expires;
+    std::chrono::steady_clock::time_point                         expires;
+    std::chrono::steady_clock::duration                           timerSlack;
+    uint64_t                                                      gen              = 0;
     bool                                                          wasCancelled     = false;
     bool                                                          allowForceUpdate = false;
 };
@@ -0,0 +1,100 @@
+#include "TimerQueue.hpp"
+#include <algorithm>
+
+static bool timerEntryLater(const auto& a, const auto& b) {
+    return a.latest > b.latest;
+}
+
+static bool timerEntryStale(const auto& e) {
+    return e.timer->cancelled() || e.generation != e.timer->generation();
+}
+
+void CTimerQueue::schedule(const std::shared_ptr<CTimer>& timer) {
+    const auto                  EXPIRES = timer->expiresAt();
+    const auto                  LATEST  = EXPIRES == std::chrono::steady_clock::time_point::max() ? EXPIRES : EXPIRES + timer->slack();
+
+    std::lock_guard<std::mutex> lg(m_mutex);
+    m_vTimers.emplace_back(STimerEntry{LATEST, EXPIRES, timer->generation(), timer});
+    std::push_heap(m_vTimers.begin(), m_vTimers.end(), timerEntryLater<STimerEntry, STimerEntry>);
+    m_tMaxSlack = std::max(m_tMaxSlack, timer->slack());
+}
+
+std::optional<std::chrono::steady_clock::time_point> CTimerQueue::nextDeadline() {
+    std::lock_guard<std::mutex> lg(m_mutex);
+
+    // drop stale entries once they make up a good chunk of the heap
+    if (m_vTimers.size() > m_iCompactThreshold) {
+        std::erase_if(m_vTimers, [](const auto& e) { return timerEntryStale(e); });
+        std::make_heap(m_vTimers.begin(), m_vTimers.end(), timerEntryLater<STimerEntry, STimerEntry>);
+        m_iCompactThreshold = std::max<size_t>(64, m_vTimers.size() * 2);
+    }
+
+    while (!m_vTimers.empty() && timerEntryStale(m_vTimers.front())) {
+        std::pop_heap(m_vTimers.begin(), m_vTimers.end(), timerEntryLater<STimerEntry, STimerEntry>);
+        m_vTimers.pop_back();
+    }
+
+    // only force update timers left
+    if (m_vTimers.empty() || m_vTimers.front().latest == std::chrono::steady_clock::time_point::max())
+        return std::nullopt;
+
+    // the heap is ordered by the latest point each timer may fire at, so waking up here satisfies everyone's slack
+    return m_vTimers.front().latest;
+}
+
+void CTimerQueue::dispatch(const std::chrono::steady_clock::time_point& now) {
+    m_vDueTimers.clear();
+
+    {
+        std::lock_guard<std::mutex> lg(m_mutex);
+
+        // A due timer has latest <= now + max slack, and children in the heap are never earlier than their parent, so only that part of the tree is walked.
+        const auto BOUND = now + m_tMaxSlack;
+        m_vTimerWalk.clear();
+        if (!m_vTimers.empty())
+            m_vTimerWalk.push_back(0);
+
+        while (!m_vTimerWalk.empty()) {
+            const size_t IDX = m_vTimerWalk.back();
+            m_vTimerWalk.pop_back();
+
+            const auto& E = m_vTimers[IDX];
+            if (E.latest > BOUND)
+                continue;
+
+            if (E.expires <= now && !timerEntryStale(E))
+                m_vDueTimers.push_back(E);
+
+            for (size_t child = IDX * 2 + 1; child <= IDX * 2 + 2 && child < m_vTimers.size(); ++child) {
+                m_vTimerWalk.push_back(child);
+            }
+        }
+    }
+
+    // fire in expiry order
+    std::sort(m_vDueTimers.begin(), m_vDueTimers.end(), [](const auto& a, const auto& b) { return a.expires < b.expires; });
+
+    for (auto& e : m_vDueTimers) {
+        // an earlier callback might have cancelled or re-armed this one
+        if (timerEntryStale(e))
+            continue;
+
+        // leaves a stale entry behind, which gets popped before the next wait
+        e.timer->disarm();
+        e.timer->call(e.timer);
+    }
+
+    m_vDueTimers.clear();
+}
+
+std::vector<std::shared_ptr<CTimer>> CTimerQueue::timers() {
+    std::lock_guard<std::mutex>          lg(m_mutex);
+    std::vector<std::shared_ptr<CTimer>> timers;
+
+    for (const auto& e : m_vTimers) {
+        if (!timerEntryStale(e))
+            timers.push_back(e.timer);
+    }
+
+    return timers;
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include "Timer.hpp"
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+// The armed CTimers, ordered by the latest point each of them may fire at (expiry + slack). Any thread may schedule, the main thread dispatches.
+class CTimerQueue {
+  public:
+    // (re)schedules the timer at its current expiry. Entries of earlier arms go stale through the timer's generation.
+    void                                                 schedule(const std::shared_ptr<CTimer>& timer);
+
+    // where the loop should wake up next, nullopt if only force update timers are left
+    std::optional<std::chrono::steady_clock::time_point> nextDeadline();
+
+    // Fires every timer expired by now in expiry order, not only the ones whose slack ran out, so timers close to each other fire in one go.
+    // Called without the lock, callbacks are free to add or re-arm timers.
+    void                                                 dispatch(const std::chrono::steady_clock::time_point& now);
+
+    std::vector<std::shared_ptr<CTimer>>                 timers();
+
+  private:
+    struct STimerEntry {
+        std::chrono::steady_clock::time_point latest; // expires + slack
+        std::chrono::steady_clock::time_point expires;
+        uint64_t                              generation = 0;
+        std::shared_ptr<CTimer>               timer;
+    };
+
+    std::mutex                                           m_mutex;
+
+    // min-heap on latest. Cancelled, fired and re-armed timers leave stale entries behind, which are skipped when popped
+    std::vector<STimerEntry>                             m_vTimers;
+    std::vector<STimerEntry>                             m_vDueTimers;
+    std::vector<size_t>                                  m_vTimerWalk;
+    size_t                                               m_iCompactThreshold = 64;
+    std::chrono::steady_clock::duration                  m_tMaxSlack         = std::chrono::steady_clock::duration::zero();
+};
@@ -2,12 +2,13 @@
 #include "../helpers/Log.hpp"
 #include "../config/ConfigManager.hpp"
 #include "../renderer/Renderer.hpp"
+#include "Animation.hpp"
 #include "Auth.hpp"
 #include "Egl.hpp"
 #include "Fingerprint.hpp"
+#include "DataProviders.hpp"
 #include "linux-dmabuf-unstable-v1-protocol.h"
 #include <sys/wait.h>
-#include <sys/poll.h>
 #include <sys/mman.h>
 #include <fcntl.h>
 #include <signal.h>
@@ -20,7 +21,7 @@
 #include <algorithm>
 #include <sdbus-c++/sdbus-c++.h>
 
-CHyprlock::CHyprlock(const std::string& wlDisplay, const bool immediate, const bool immediateRender, const bool noFadeIn) {
+CHyprlock::CHyprlock(const std::string& wlDisplay, const bool immediate, const bool immediateRender, const bool noFadeIn, const bool daemon) {
     m_sWaylandState.display = wl_display_connect(wlDisplay.empty() ? nullptr : wlDisplay.c_str());
     if (!m_sWaylandState.display) {
         Debug::log(CRIT, "Couldn't connect to a wayland compositor");
@@ -29,16 +30,18 @@ CHyprlock::CHyprlock(const std::string& wlDisplay, const bool immediate, const b
 
     g_pEGL = std::make_unique<CEGL>(m_sWaylandState.display);
 
+    m_pEventLoop    = std::make_unique<CEventLoop>();
+    m_pTaskQueue    = std::make_unique<CTaskQueue>();
+    m_pTimerQueue   = std::make_unique<CTimerQueue>();
+    m_iMainThreadID = std::this_thread::get_id();
+
     m_pXKBContext = xkb_context_new(XKB_CONTEXT_NO_FLAGS);
     if (!m_pXKBContext)
         Debug::log(ERR, "Failed to create xkb context");
 
-    if (!immediate) {
-        const auto PGRACE = (Hyprlang::INT* const*)g_pConfigManager->getValuePtr("general:grace");
-        m_tGraceEnds      = **PGRACE ? std::chrono::system_clock::now() + std::chrono::seconds(**PGRACE) : std::chrono::system_clock::from_time_t(0);
-    } else {
-        m_tGraceEnds = std::chrono::system_clock::from_time_t(0);
-    }
+    // the grace period starts with each lock, see lockSession
+    m_sLockState.immediate = immediate;
+    m_bDaemon              = daemon;
 
     const auto PIMMEDIATERENDER = (Hyprlang::INT* const*)g_pConfigManager->getValuePtr("general:immediate_render");
     m_bImmediateRender          = immediateRender || **PIMMEDIATERENDER;
@@ -331,28 +334,46 @@ static void registerSignalAction(int sig, void (*handler)(int), int sa_flags = 0
 
 static void handleUnlockSignal(int sig) {
     if (sig == SIGUSR1) {
-        Debug::log(LOG, "Unlocking with a SIGUSR1");
-        g_pHyprlock->releaseSessionLock();
+        g_pHyprlock->requestUnlock();
     }
 }
 
 static void forceUpdateTimers() {
     for (auto& t : g_pHyprlock->getTimers()) {
         if (t->canForceUpdate()) {
+            // cancel first, the callback may re-arm it
+            t->cancel();
             t->call(t);
+        }
+    }
+}
+
+static void resyncWallClockTimers() {
+    for (auto& t : g_pHyprlock->getTimers()) {
+        if (t->wallClockAligned) {
+            // the callback computes the next boundary from the new time
             t->cancel();
+            t->call(t);
         }
     }
 }
 
 static void handleForceUpdateSignal(int sig) {
     if (sig == SIGUSR2) {
-        forceUpdateTimers();
+        g_pHyprlock->requestForceUpdate();
     }
 }
 
-static void handlePollTerminate(int sig) {
-    ;
+static void handleWakeupDumpSignal(int sig) {
+    g_pHyprlock->m_pEventLoop->requestWakeupDump();
+}
+
+static void handleLockSignal(int sig) {
+    g_pHyprlock->requestLock();
+}
+
+static void handleExitSignal(int sig) {
+    g_pHyprlock->requestExit();
 }
 
 static void handleCriticalSignal(int sig) {
@@ -384,24 +405,85 @@ void CHyprlock::run() {
     // gather info about monitors
     wl_display_roundtrip(m_sWaylandState.display);
 
-    g_pRenderer = std::make_unique<CRenderer>();
+    g_pAnimationManager = std::make_unique<CAnimationManager>();
+    g_pRenderer         = std::make_unique<CRenderer>();
+
+    Debug::log(LOG, "Running on {}", m_sCurrentDesktop);
+
+    m_sWaylandState.fd = wl_display_get_fd(m_sWaylandState.display);
+    m_pEventLoop->addFd(
+        m_sWaylandState.fd, EPOLLIN,
+        [this](uint32_t events) {
+            if (events & (EPOLLHUP | EPOLLERR)) {
+                Debug::log(CRIT, "[core] Disconnected from the wayland socket");
+                attemptRestoreOnDeath();
+                m_bTerminate = true;
+                exit(1);
+            }
+        },
+        "wayland");
+
+    m_pEventLoop->setClockChangedCallback(resyncWallClockTimers);
+
+    m_pProcessExecutor = std::make_unique<CProcessExecutor>();
+    g_pDataProviders   = std::make_unique<CDataProviders>();
+
+    registerSignalAction(SIGUSR1, handleUnlockSignal, SA_RESTART);
+    registerSignalAction(SIGUSR2, handleForceUpdateSignal);
+    registerSignalAction(SIGRTMIN, handleWakeupDumpSignal, SA_RESTART);
+    registerSignalAction(SIGSEGV, handleCriticalSignal);
+    registerSignalAction(SIGABRT, handleCriticalSignal);
+
+    m_pControlSocket = std::make_unique<CControlSocket>();
+    registerControlCommands();
+
+    if (!m_pControlSocket->start())
+        Debug::log(WARN, m_bDaemon ? "No control socket, the daemon can only be locked with SIGRTMIN+1" : "No control socket");
+
+    if (m_bDaemon)
+        runDaemon();
+    else {
+        m_sLockState.requestedAt = std::chrono::steady_clock::now();
+        lockSession();
+    }
+
+    m_pControlSocket.reset();
+
+    g_pRenderer->asyncResourceGatherer->notify();
+    g_pRenderer->asyncResourceGatherer->await();
+
+    m_vOutputs.clear();
+    g_pEGL.reset();
+    g_pRenderer = nullptr;
+    g_pAnimationManager.reset();
+    g_pDataProviders.reset();
+    m_pProcessExecutor.reset();
+
+    xkb_context_unref(m_pXKBContext);
+
+    m_pEventLoop->dumpWakeups();
+    m_pEventLoop->removeFd(m_sWaylandState.fd);
+    wl_display_disconnect(m_sWaylandState.display);
+
+    Debug::log(LOG, "Reached the end, exiting");
+}
 
+void CHyprlock::lockSession() {
     static auto* const PNOFADEOUT = (Hyprlang::INT* const*)g_pConfigManager->getValuePtr("general:no_fade_out");
+    static auto* const PGRACE     = (Hyprlang::INT* const*)g_pConfigManager->getValuePtr("general:grace");
     const bool         NOFADEOUT  = **PNOFADEOUT;
 
-    Debug::log(LOG, "Running on {}", m_sCurrentDesktop);
+    m_tGraceEnds = !m_sLockState.immediate && **PGRACE ? std::chrono::system_clock::now() + std::chrono::seconds(**PGRACE) : std::chrono::system_clock::from_time_t(0);
+
+    // the daemon took its screenshots when it started
+    if (m_bDaemon)
+        g_pRenderer->asyncResourceGatherer->recaptureScreenshots();
 
     // Hyprland violates the protocol a bit to allow for this.
     if (m_sCurrentDesktop != "Hyprland") {
+        // the gatherer posts a task once it's done, which wakes us up
         while (!g_pRenderer->asyncResourceGatherer->gathered) {
-            wl_display_flush(m_sWaylandState.display);
-            if (wl_display_prepare_read(m_sWaylandState.display) == 0) {
-                wl_display_read_events(m_sWaylandState.display);
-                wl_display_dispatch_pending(m_sWaylandState.display);
-            } else {
-                wl_display_dispatch(m_sWaylandState.display);
-            }
-            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            dispatchEvents();
         }
     }
 
@@ -409,193 +491,232 @@ void CHyprlock::run() {
 
     // Recieved finished
     if (m_bTerminate) {
-        m_sLoopState.timerEvent = true;
-        m_sLoopState.timerCV.notify_all();
+        if (m_bDaemon) {
+            Debug::log(ERR, "Failed to lock the session");
+            return;
+        }
+
         g_pRenderer->asyncResourceGatherer->notify();
         g_pRenderer->asyncResourceGatherer->await();
         exit(1);
     }
 
-    g_pAuth = std::make_unique<CAuth>();
+    g_pAuth = std::make_shared<CAuth>();
     g_pAuth->start();
 
     g_pFingerprint                           = std::make_unique<CFingerprint>();
     std::shared_ptr<sdbus::IConnection> conn = g_pFingerprint->start();
 
-    registerSignalAction(SIGUSR1, handleUnlockSignal, SA_RESTART);
-    registerSignalAction(SIGUSR2, handleForceUpdateSignal);
-    registerSignalAction(SIGRTMIN, handlePollTerminate);
-    registerSignalAction(SIGSEGV, handleCriticalSignal);
-    registerSignalAction(SIGABRT, handleCriticalSignal);
-
     createSessionLockSurfaces();
 
-    pollfd pollfds[2];
-    pollfds[0] = {
-        .fd     = wl_display_get_fd(m_sWaylandState.display),
-        .events = POLLIN,
-    };
+    const int DBUSFD = conn ? conn->getEventLoopPollData().fd : -1;
     if (conn) {
-        pollfds[1] = {
-            .fd     = conn->getEventLoopPollData().fd,
-            .events = POLLIN,
-        };
+        m_pEventLoop->addFd(
+            DBUSFD, EPOLLIN,
+            [conn](uint32_t events) {
+                while (conn->processPendingEvent()) {
+                    ;
+                }
+            },
+            "dbus");
     }
-    size_t      fdcount = conn ? 2 : 1;
 
-    std::thread pollThr([this, &pollfds, fdcount]() {
-        while (!m_bTerminate) {
-            int ret = poll(pollfds, fdcount, 5000 /* 5 seconds, reasonable. Just in case we need to terminate and the signal fails */);
+    while (!m_bTerminate) {
+        dispatchEvents();
 
-            if (ret < 0) {
-                if (errno == EINTR)
-                    continue;
+        if (!NOFADEOUT && m_bFadeStarted && std::chrono::steady_clock::now() > m_tFadeEnds) {
+            releaseSessionLock();
+            break;
+        }
+    }
 
-                Debug::log(CRIT, "[core] Polling fds failed with {}", errno);
-                attemptRestoreOnDeath();
-                m_bTerminate = true;
-                exit(1);
-            }
+    if (conn)
+        m_pEventLoop->removeFd(DBUSFD);
 
-            for (size_t i = 0; i < fdcount; ++i) {
-                if (pollfds[i].revents & POLLHUP) {
-                    Debug::log(CRIT, "[core] Disconnected from pollfd id {}", i);
-                    attemptRestoreOnDeath();
-                    m_bTerminate = true;
-                    exit(1);
-                }
-            }
+    g_pAuth->terminate();
+    g_pFingerprint->terminate();
+}
 
-            if (ret != 0) {
-                Debug::log(TRACE, "[core] got poll event");
-                std::lock_guard<std::mutex> lg2(m_sLoopState.eventLoopMutex);
-                m_sLoopState.event = true;
-                m_sLoopState.loopCV.notify_all();
-            }
-        }
+void CHyprlock::runDaemon() {
+    m_pControlSocket->registerCommand("lock", [this](const std::string&) -> std::string {
+        requestLock();
+        return "ok";
     });
 
-    std::thread timersThr([this]() {
-        while (!m_bTerminate) {
-            // calc nearest thing
-            m_sLoopState.timersMutex.lock();
+    registerSignalAction(SIGRTMIN + 1, handleLockSignal, SA_RESTART);
+    registerSignalAction(SIGTERM, handleExitSignal, SA_RESTART);
+    registerSignalAction(SIGINT, handleExitSignal, SA_RESTART);
 
-            float least = 10000;
-            for (auto& t : m_vTimers) {
-                const auto TIME = std::clamp(t->leftMs(), 1.f, INFINITY);
-                if (TIME < least)
-                    least = TIME;
-            }
+    // fontconfig and pango set up their caches on the first text, do that now rather than on the first lock
+    CAsyncResourceGatherer::SPreloadRequest warmup;
+    warmup.type  = CAsyncResourceGatherer::TARGET_TEXT;
+    warmup.id    = "daemon:warmup";
+    warmup.asset = "hyprlock";
+    g_pRenderer->asyncResourceGatherer->requestAsyncAssetPreload(warmup);
 
-            m_sLoopState.timersMutex.unlock();
+    // Everything but the lock itself is set up by now. Widgets are created once the lock surfaces get configured.
+    Debug::log(LOG, "Daemon ready, waiting for a lock request");
 
-            std::unique_lock lk(m_sLoopState.timerRequestMutex);
-            m_sLoopState.timerCV.wait_for(lk, std::chrono::milliseconds((int)least + 1), [this] { return m_sLoopState.timerEvent; });
-            m_sLoopState.timerEvent = false;
+    while (!m_sLockState.exitRequested) {
+        dispatchEvents();
 
-            // notify main
-            std::lock_guard<std::mutex> lg2(m_sLoopState.eventLoopMutex);
-            Debug::log(TRACE, "timer thread firing");
-            m_sLoopState.event = true;
-            m_sLoopState.loopCV.notify_all();
-        }
+        if (!m_sLockState.requested.exchange(false))
+            continue;
+
+        m_sLockState.requestedAt = std::chrono::steady_clock::now();
+
+        lockSession();
+        resetLockState();
+
+        // requests that came in while locked are stale
+        m_sLockState.requested = false;
+    }
+
+    Debug::log(LOG, "Daemon exiting");
+
+    m_bTerminate = true;
+}
+
+void CHyprlock::resetLockState() {
+    // run what the last lock left behind, while isUnlocked() still says so
+    m_pTaskQueue->drain();
+
+    if (m_pKeyRepeatTimer)
+        m_pKeyRepeatTimer->cancel();
+
+    g_pEGL->makeCurrent(nullptr);
+    for (auto& o : m_vOutputs) {
+        o->sessionLockSurface.reset();
+    }
+
+    g_pRenderer->reset();
+
+    g_pFingerprint.reset();
+    g_pAuth.reset();
+
+    m_sPasswordState = {};
+    m_vPressedKeys.clear();
+    m_iKeebRepeatSym = 0;
+
+    m_bLocked      = false;
+    m_bFadeStarted = false;
+    m_bTerminate   = false;
+
+    Debug::log(LOG, "Unlocked, waiting for the next lock request");
+}
+
+void CHyprlock::registerControlCommands() {
+    m_pControlSocket->registerCommand("state", [this](const std::string&) -> std::string {
+        if (m_bLocked)
+            return "locked";
+
+        return m_sLockState.lock ? "locking" : "unlocked";
     });
 
-    m_sLoopState.event = true; // let it process once
+    // e.g. `refresh battery` after a status daemon noticed a change, rather than waking every timer with SIGUSR2
+    m_pControlSocket->registerCommand("refresh", [](const std::string& id) -> std::string {
+        if (id.empty())
+            return "error: usage: refresh <id>";
 
-    while (!m_bTerminate) {
-        std::unique_lock lk(m_sLoopState.eventRequestMutex);
-        if (m_sLoopState.event == false)
-            m_sLoopState.loopCV.wait_for(lk, std::chrono::milliseconds(5000), [this] { return m_sLoopState.event; });
+        const auto REFRESHED = g_pRenderer->refreshWidgets(id);
+        return REFRESHED > 0 ? std::format("ok: {} widgets", REFRESHED) : std::format("error: no widget with id {}", id);
+    });
 
-        if (!NOFADEOUT && m_bFadeStarted && std::chrono::system_clock::now() > m_tFadeEnds) {
-            releaseSessionLock();
-            break;
-        }
+    m_pControlSocket->registerCommand("prewarm", [](const std::string& path) -> std::string {
+        if (path.empty())
+            return "error: usage: prewarm <path>";
 
-        if (m_bTerminate)
-            break;
+        const auto REQUESTED = g_pRenderer->asyncResourceGatherer->reloadImage(path);
+        return REQUESTED > 0 ? std::format("ok: {} assets", REQUESTED) : std::format("error: no background or image uses {}", path);
+    });
 
-        std::lock_guard<std::mutex> lg(m_sLoopState.eventLoopMutex);
+    m_pControlSocket->registerCommand("metrics", [this](const std::string&) -> std::string {
+        size_t        rssPages = 0;
+        std::ifstream statm("/proc/self/statm");
+        statm >> rssPages >> rssPages;
 
-        m_sLoopState.event = false;
+        const auto RSSKIB   = rssPages * sysconf(_SC_PAGESIZE) / 1024;
+        const auto ASSETKIB = g_pRenderer->asyncResourceGatherer->assetBytes() / 1024;
 
-        if (pollfds[1].revents & POLLIN /* dbus */) {
-            while (conn && conn->processPendingEvent()) {
-                ;
-            }
-        }
+        return std::format("rss: {} KiB\nassets: {} ({} KiB)\ntimers: {}\nlast lock latency: {}ms\n{}\n{}\n{}", RSSKIB, g_pRenderer->asyncResourceGatherer->assetCount(),
+                           ASSETKIB, getTimers().size(), std::chrono::duration_cast<std::chrono::milliseconds>(m_sLockState.latency).count(), m_pEventLoop->wakeupStats(),
+                           g_pRenderer->glState.stats(), g_pRenderer->framebufferPool.stats());
+    });
+}
 
-        if (pollfds[0].revents & POLLIN /* wl */) {
-            Debug::log(TRACE, "got wl event");
-            wl_display_flush(m_sWaylandState.display);
-            if (wl_display_prepare_read(m_sWaylandState.display) == 0) {
-                wl_display_read_events(m_sWaylandState.display);
-                wl_display_dispatch_pending(m_sWaylandState.display);
-            } else {
-                wl_display_dispatch(m_sWaylandState.display);
-            }
-        }
+void CHyprlock::requestLock() {
+    m_sLockState.requested = true;
+    m_pEventLoop->wakeup(CEventLoop::WAKEUP_SIGNAL);
+}
 
-        // finalize wayland dispatching. Dispatch pending on the queue
-        int ret = 0;
-        do {
-            ret = wl_display_dispatch_pending(m_sWaylandState.display);
-            wl_display_flush(m_sWaylandState.display);
-        } while (ret > 0 && !m_bTerminate);
+void CHyprlock::requestExit() {
+    m_sLockState.exitRequested = true;
+    m_pEventLoop->wakeup(CEventLoop::WAKEUP_SIGNAL);
+}
 
-        // do timers
-        m_sLoopState.timersMutex.lock();
-        auto timerscpy = m_vTimers;
-        m_sLoopState.timersMutex.unlock();
+void CHyprlock::requestUnlock() {
+    // the main thread may be in the middle of a wayland read, releasing the lock from here would deadlock on it
+    m_sLoopState.unlockRequested = true;
+    m_pEventLoop->wakeup(CEventLoop::WAKEUP_SIGNAL);
+}
 
-        std::vector<std::shared_ptr<CTimer>> passed;
+void CHyprlock::requestForceUpdate() {
+    // the main thread may be going through the timers
+    m_sLoopState.forceUpdateRequested = true;
+    m_pEventLoop->wakeup(CEventLoop::WAKEUP_SIGNAL);
+}
 
-        for (auto& t : timerscpy) {
-            if (t->passed() && !t->cancelled()) {
-                t->call(t);
-                passed.push_back(t);
-            }
+void CHyprlock::dispatchEvents() {
+    // flush what we have queued and prepare the read before blocking, so no events get stuck in the queue
+    while (wl_display_prepare_read(m_sWaylandState.display) != 0) {
+        wl_display_dispatch_pending(m_sWaylandState.display);
+    }
+    wl_display_flush(m_sWaylandState.display);
 
-            if (t->cancelled())
-                passed.push_back(t);
-        }
+    // arm the timerfd to the nearest timer
+    auto deadline = m_pTimerQueue->nextDeadline();
 
-        m_sLoopState.timersMutex.lock();
-        std::erase_if(m_vTimers, [passed](const auto& timer) { return std::find(passed.begin(), passed.end(), timer) != passed.end(); });
-        m_sLoopState.timersMutex.unlock();
+    if (m_bFadeStarted && (!deadline.has_value() || m_tFadeEnds < *deadline))
+        deadline = m_tFadeEnds;
 
-        passed.clear();
+    m_pEventLoop->armTimer(deadline);
 
-        if (!NOFADEOUT && m_bFadeStarted && std::chrono::system_clock::now() > m_tFadeEnds) {
-            releaseSessionLock();
-            break;
-        }
+    if (m_pEventLoop->wait() < 0) {
+        wl_display_cancel_read(m_sWaylandState.display);
+        attemptRestoreOnDeath();
+        m_bTerminate = true;
+        exit(1);
     }
 
-    m_sLoopState.timerEvent = true;
-    m_sLoopState.timerCV.notify_all();
-    g_pRenderer->asyncResourceGatherer->notify();
-    g_pRenderer->asyncResourceGatherer->await();
+    // finish the wayland read before anything else touches the display
+    if (m_pEventLoop->isReady(m_sWaylandState.fd)) {
+        Debug::log(TRACE, "got wl event");
+        wl_display_read_events(m_sWaylandState.display);
+    } else
+        wl_display_cancel_read(m_sWaylandState.display);
 
-    m_vOutputs.clear();
-    g_pEGL.reset();
-    g_pRenderer = nullptr;
+    if (m_sLoopState.unlockRequested.exchange(false)) {
+        Debug::log(LOG, "Unlocking with a SIGUSR1");
+        releaseSessionLock();
+    }
 
-    xkb_context_unref(m_pXKBContext);
+    if (m_sLoopState.forceUpdateRequested.exchange(false))
+        forceUpdateTimers();
 
-    wl_display_disconnect(m_sWaylandState.display);
+    m_pEventLoop->dispatch();
 
-    pthread_kill(pollThr.native_handle(), SIGRTMIN);
+    // finalize wayland dispatching. Dispatch pending on the queue
+    int ret = 0;
+    do {
+        ret = wl_display_dispatch_pending(m_sWaylandState.display);
+        wl_display_flush(m_sWaylandState.display);
+    } while (ret > 0 && !m_bTerminate);
 
-    g_pAuth->terminate();
-    g_pFingerprint->terminate();
+    m_pTaskQueue->drain();
 
-    // wait for threads to exit cleanly to avoid a coredump
-    pollThr.join();
-    timersThr.join();
+    m_pTimerQueue->dispatch(std::chrono::steady_clock::now());
 
-    Debug::log(LOG, "Reached the end, exiting");
+    renderScheduledOutputs();
 }
 
 void CHyprlock::unlock() {
@@ -606,7 +727,7 @@ void CHyprlock::unlock() {
         return;
     }
 
-    m_tFadeEnds    = std::chrono::system_clock::now() + std::chrono::milliseconds(500);
+    m_tFadeEnds    = std::chrono::steady_clock::now() + std::chrono::milliseconds(500);
     m_bFadeStarted = true;
 
     renderAllOutputs();
@@ -751,7 +872,7 @@ static void handleKeyboardModifiers(void* data, wl_keyboard* wl_keyboard, uint s
 
     if (group != g_pHyprlock->m_uiActiveLayout) {
         g_pHyprlock->m_uiActiveLayout = group;
-        forceUpdateTimers();
+        g_pDataProviders->update("LAYOUT");
     }
 
     xkb_state_update_mask(g_pHyprlock->m_pXKBState, mods_depressed, mods_latched, mods_locked, 0, 0, group);
@@ -809,6 +930,10 @@ static const ext_session_lock_v1_listener sessionLockListener = {
 // end session_lock
 
 void CHyprlock::onPasswordCheckTimer() {
+    // a late result from the previous lock of the daemon
+    if (isUnlocked())
+        return;
+
     // check result
     if (g_pAuth->isAuthenticated()) {
         unlock();
@@ -818,11 +943,12 @@ void CHyprlock::onPasswordCheckTimer() {
         Debug::log(LOG, "Failed attempts: {}", m_sPasswordState.failedAttempts);
 
         g_pAuth->m_bDisplayFailText = true;
-        forceUpdateTimers();
+        g_pDataProviders->update("FAIL");
+        g_pDataProviders->update("ATTEMPTS");
 
         g_pAuth->start();
 
-        renderAllOutputs();
+        renderInputFieldOutputs();
     }
 }
 
@@ -832,7 +958,7 @@ void CHyprlock::clearPasswordBuffer() {
 
     m_sPasswordState.passBuffer = "";
 
-    renderAllOutputs();
+    renderInputFieldOutputs();
 }
 
 void CHyprlock::renderOutput(const std::string& stringPort) {
@@ -858,11 +984,33 @@ void CHyprlock::renderAllOutputs() {
     }
 }
 
+void CHyprlock::renderInputFieldOutputs() {
+    for (auto& o : m_vOutputs) {
+        if (!o->sessionLockSurface || !g_pRenderer->hasInputField(o->sessionLockSurface.get()))
+            continue;
+
+        o->sessionLockSurface->render();
+    }
+}
+
+void CHyprlock::renderScheduledOutputs() {
+    if (m_bTerminate || !g_pEGL)
+        return;
+
+    // one frame time for every surface rendered in this iteration
+    g_pAnimationManager->tick();
+
+    for (auto& o : m_vOutputs) {
+        if (!o->sessionLockSurface)
+            continue;
+
+        o->sessionLockSurface->renderIfNeeded();
+    }
+}
+
 void CHyprlock::startKeyRepeat(xkb_keysym_t sym) {
-    if (m_pKeyRepeatTimer) {
+    if (m_pKeyRepeatTimer)
         m_pKeyRepeatTimer->cancel();
-        m_pKeyRepeatTimer.reset();
-    }
 
     if (m_pXKBComposeState)
         xkb_compose_state_reset(m_pXKBComposeState);
@@ -870,7 +1018,14 @@ void CHyprlock::startKeyRepeat(xkb_keysym_t sym) {
     if (m_iKeebRepeatDelay <= 0)
         return;
 
-    m_pKeyRepeatTimer = addTimer(std::chrono::milliseconds(m_iKeebRepeatDelay), [sym](std::shared_ptr<CTimer> self, void* data) { g_pHyprlock->repeatKey(sym); }, nullptr);
+    m_iKeebRepeatSym = sym;
+
+    // one timer for the whole session, re-armed on every press and repeat
+    if (!m_pKeyRepeatTimer)
+        m_pKeyRepeatTimer = addTimer(std::chrono::milliseconds(m_iKeebRepeatDelay),
+                                     [](std::shared_ptr<CTimer> self, void* data) { g_pHyprlock->repeatKey(g_pHyprlock->m_iKeebRepeatSym); }, nullptr);
+    else
+        rearmTimer(m_pKeyRepeatTimer, std::chrono::milliseconds(m_iKeebRepeatDelay));
 }
 
 void CHyprlock::repeatKey(xkb_keysym_t sym) {
@@ -881,9 +1036,9 @@ void CHyprlock::repeatKey(xkb_keysym_t sym) {
 
     // This condition is for backspace and delete keys, but should also be ok for other keysyms since our buffer won't be empty anyways
     if (bool CONTINUE = m_sPasswordState.passBuffer.length() > 0; CONTINUE)
-        m_pKeyRepeatTimer = addTimer(std::chrono::milliseconds(m_iKeebRepeatRate), [sym](std::shared_ptr<CTimer> self, void* data) { g_pHyprlock->repeatKey(sym); }, nullptr);
+        rearmTimer(m_pKeyRepeatTimer, std::chrono::milliseconds(m_iKeebRepeatRate));
 
-    renderAllOutputs();
+    renderInputFieldOutputs();
 }
 
 void CHyprlock::onKey(uint32_t key, bool down) {
@@ -907,14 +1062,12 @@ void CHyprlock::onKey(uint32_t key, bool down) {
         m_vPressedKeys.push_back(key);
     else {
         std::erase(m_vPressedKeys, key);
-        if (m_pKeyRepeatTimer) {
+        if (m_pKeyRepeatTimer)
             m_pKeyRepeatTimer->cancel();
-            m_pKeyRepeatTimer.reset();
-        }
     }
 
     if (g_pAuth->checkWaiting()) {
-        renderAllOutputs();
+        renderInputFieldOutputs();
         return;
     }
 
@@ -939,7 +1092,7 @@ void CHyprlock::onKey(uint32_t key, bool down) {
     } else if (m_pXKBComposeState && xkb_compose_state_get_status(m_pXKBComposeState) == XKB_COMPOSE_COMPOSED)
         xkb_compose_state_reset(m_pXKBComposeState);
 
-    renderAllOutputs();
+    renderInputFieldOutputs();
 }
 
 void CHyprlock::handleKeySym(xkb_keysym_t sym, bool composed) {
@@ -1028,6 +1181,11 @@ void CHyprlock::createSessionLockSurfaces() {
 void CHyprlock::onLockLocked() {
     Debug::log(LOG, "onLockLocked called");
 
+    m_sLockState.latency = std::chrono::steady_clock::now() - m_sLockState.requestedAt;
+
+    if (m_bDaemon)
+        Debug::log(LOG, "Locked {}ms after the lock request", std::chrono::duration_cast<std::chrono::milliseconds>(m_sLockState.latency).count());
+
     m_bLocked = true;
 }
 
@@ -1088,21 +1246,33 @@ size_t CHyprlock::getPasswordFailedAttempts() {
     return m_sPasswordState.failedAttempts;
 }
 
-std::shared_ptr<CTimer> CHyprlock::addTimer(const std::chrono::system_clock::duration& timeout, std::function<void(std::shared_ptr<CTimer> self, void* data)> cb_, void* data,
-                                            bool force) {
-    std::lock_guard<std::mutex> lg(m_sLoopState.timersMutex);
-    const auto                  T = m_vTimers.emplace_back(std::make_shared<CTimer>(timeout, cb_, data, force));
-    m_sLoopState.timerEvent       = true;
-    m_sLoopState.timerCV.notify_all();
+std::shared_ptr<CTimer> CHyprlock::addTimer(const std::chrono::steady_clock::duration& timeout, std::function<void(std::shared_ptr<CTimer> self, void* data)> cb_, void* data,
+                                            bool force, const std::chrono::steady_clock::duration& slack) {
+    const auto T = std::make_shared<CTimer>(timeout, cb_, data, force, slack);
+    m_pTimerQueue->schedule(T);
+    // the main thread recalculates the timerfd deadline before blocking anyways
+    if (std::this_thread::get_id() != m_iMainThreadID)
+        m_pEventLoop->wakeup();
     return T;
 }
 
+void CHyprlock::rearmTimer(const std::shared_ptr<CTimer>& timer, const std::chrono::steady_clock::duration& timeout) {
+    timer->arm(timeout);
+    // the loop picks up the new deadline before it blocks again
+    m_pTimerQueue->schedule(timer);
+}
+
 std::vector<std::shared_ptr<CTimer>> CHyprlock::getTimers() {
-    return m_vTimers;
+    return m_pTimerQueue->timers();
+}
+
+void CHyprlock::addTask(std::function<void()> task, CEventLoop::eWakeupSource source) {
+    if (m_pTaskQueue->push(std::move(task)))
+        m_pEventLoop->wakeup(source);
 }
 
-void CHyprlock::enqueueForceUpdateTimers() {
-    addTimer(std::chrono::milliseconds(1), [](std::shared_ptr<CTimer> self, void* data) { forceUpdateTimers(); }, nullptr, false);
+void CHyprlock::enqueueVariableUpdate(const std::string& name) {
+    addTask([name]() { g_pDataProviders->update(name); });
 }
 
 void CHyprlock::spawnAsync(const std::string& args) {
@@ -1183,6 +1353,10 @@ void CHyprlock::attemptRestoreOnDeath() {
     if (m_bTerminate || m_sCurrentDesktop != "Hyprland")
         return;
 
+    // an idle daemon has nothing to restore
+    if (m_bDaemon && !m_sLockState.lock)
+        return;
+
     const auto XDG_RUNTIME_DIR = getenv("XDG_RUNTIME_DIR");
     const auto HIS             = getenv("HYPRLAND_INSTANCE_SIGNATURE");
 
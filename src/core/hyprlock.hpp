@@ -8,9 +8,16 @@
 #include "Output.hpp"
 #include "CursorShape.hpp"
 #include "Timer.hpp"
+#include "EventLoop.hpp"
+#include "TaskQueue.hpp"
+#include "TimerQueue.hpp"
+#include "ControlSocket.hpp"
+#include "ProcessExecutor.hpp"
+#include <atomic>
 #include <memory>
 #include <vector>
-#include <condition_variable>
+#include <mutex>
+#include <thread>
 #include <optional>
 
 #include <xkbcommon/xkbcommon.h>
@@ -26,21 +33,37 @@ struct SDMABUFModifier {
 
 class CHyprlock {
   public:
-    CHyprlock(const std::string& wlDisplay, const bool immediate, const bool immediateRender, const bool noFadeIn);
+    CHyprlock(const std::string& wlDisplay, const bool immediate, const bool immediateRender, const bool noFadeIn, const bool daemon);
     ~CHyprlock();
 
     void                            run();
 
+    // Async-signal-safe. Makes the daemon lock the session.
+    void                            requestLock();
+    // Async-signal-safe. Makes the daemon exit, once it is unlocked.
+    void                            requestExit();
+    // Async-signal-safe. Releases the session lock from the event loop.
+    void                            requestUnlock();
+    // Async-signal-safe. Fires the force updatable timers from the event loop.
+    void                            requestForceUpdate();
+
     void                            unlock();
     bool                            isUnlocked();
 
     void                            onGlobal(void* data, struct wl_registry* registry, uint32_t name, const char* interface, uint32_t version);
     void                            onGlobalRemoved(void* data, struct wl_registry* registry, uint32_t name);
 
-    std::shared_ptr<CTimer>         addTimer(const std::chrono::system_clock::duration& timeout, std::function<void(std::shared_ptr<CTimer> self, void* data)> cb_, void* data,
-                                             bool force = false);
+    // slack is how late the timer may fire, so it can be batched with others
+    std::shared_ptr<CTimer>         addTimer(const std::chrono::steady_clock::duration& timeout, std::function<void(std::shared_ptr<CTimer> self, void* data)> cb_, void* data,
+                                             bool force = false, const std::chrono::steady_clock::duration& slack = std::chrono::steady_clock::duration::zero());
+    // reschedules an existing timer, main thread only
+    void                            rearmTimer(const std::shared_ptr<CTimer>& timer, const std::chrono::steady_clock::duration& timeout);
+
+    // runs the task on the main thread, safe to call from any thread
+    void                            addTask(std::function<void()> task, CEventLoop::eWakeupSource source = CEventLoop::WAKEUP_TASK);
 
-    void                            enqueueForceUpdateTimers();
+    // re-reads a label variable on the main thread, see CDataProviders::update. Safe to call from any thread.
+    void                            enqueueVariableUpdate(const std::string& name);
 
     void                            onLockLocked();
     void                            onLockFinished();
@@ -64,8 +87,11 @@ class CHyprlock {
     bool                            passwordCheckWaiting();
     std::optional<std::string>      passwordLastFailReason();
 
+    // these only schedule a frame, rendering happens once per loop iteration in renderScheduledOutputs
     void                            renderOutput(const std::string& stringPort);
     void                            renderAllOutputs();
+    void                            renderInputFieldOutputs();
+    void                            renderScheduledOutputs();
 
     size_t                          getPasswordBufferLen();
     size_t                          getPasswordBufferDisplayLen();
@@ -90,6 +116,7 @@ class CHyprlock {
 
     int32_t                         m_iKeebRepeatRate  = 25;
     int32_t                         m_iKeebRepeatDelay = 600;
+    xkb_keysym_t                    m_iKeebRepeatSym   = 0;
 
     xkb_layout_index_t              m_uiActiveLayout = 0;
 
@@ -106,15 +133,25 @@ class CHyprlock {
 
     bool                            m_bNoFadeIn = false;
 
+    // stays resident between locks, see runDaemon
+    bool                            m_bDaemon = false;
+
     std::string                     m_sCurrentDesktop = "";
 
     //
     std::chrono::system_clock::time_point m_tGraceEnds;
-    std::chrono::system_clock::time_point m_tFadeEnds;
+    std::chrono::steady_clock::time_point m_tFadeEnds;
     Vector2D                              m_vLastEnterCoords = {};
 
     std::shared_ptr<CTimer>               m_pKeyRepeatTimer = nullptr;
 
+    std::unique_ptr<CEventLoop>           m_pEventLoop;
+    std::unique_ptr<CTaskQueue>           m_pTaskQueue;
+    std::unique_ptr<CTimerQueue>          m_pTimerQueue;
+    std::unique_ptr<CControlSocket>       m_pControlSocket;
+    std::unique_ptr<CProcessExecutor>     m_pProcessExecutor;
+    std::thread::id                       m_iMainThreadID;
+
     std::vector<std::unique_ptr<COutput>> m_vOutputs;
     std::vector<std::shared_ptr<CTimer>>  getTimers();
 
@@ -143,10 +180,18 @@ class CHyprlock {
         wp_fractional_scale_manager_v1* fractional  = nullptr;
         wp_viewporter*                  viewporter  = nullptr;
         zwlr_screencopy_manager_v1*     screencopy  = nullptr;
+        int                             fd          = -1;
     } m_sWaylandState;
 
     struct {
-        ext_session_lock_v1* lock = nullptr;
+        ext_session_lock_v1*                  lock = nullptr;
+
+        bool                                  immediate     = false;
+        std::atomic<bool>                     requested     = false;
+        std::atomic<bool>                     exitRequested = false;
+        std::chrono::steady_clock::time_point requestedAt;
+        // from requestedAt to locked, for the last lock
+        std::chrono::steady_clock::duration   latency = std::chrono::steady_clock::duration::zero();
     } m_sLockState;
 
     struct {
@@ -156,20 +201,24 @@ class CHyprlock {
     } m_sPasswordState;
 
     struct {
-        std::mutex              timersMutex;
-        std::mutex              eventRequestMutex;
-        std::mutex              eventLoopMutex;
-        std::condition_variable loopCV;
-        bool                    event = false;
-
-        std::condition_variable timerCV;
-        std::mutex              timerRequestMutex;
-        bool                    timerEvent = false;
+        // set by signal handlers, handled by dispatchEvents once the wayland read is done
+        std::atomic<bool> unlockRequested      = false;
+        std::atomic<bool> forceUpdateRequested = false;
     } m_sLoopState;
 
-    std::vector<std::shared_ptr<CTimer>> m_vTimers;
+    // one iteration of the event loop: waits, then dispatches wayland, dbus, tasks and timers and renders
+    void                  dispatchEvents();
+
+    // locks and runs the loop until unlocked
+    void                  lockSession();
+    // waits for lock requests and locks, until asked to exit
+    void                  runDaemon();
+    // back to the unlocked state, so the daemon can lock again
+    void                  resetLockState();
+    // state, refresh, metrics and prewarm on m_pControlSocket
+    void                  registerControlCommands();
 
-    std::vector<uint32_t>                m_vPressedKeys;
+    std::vector<uint32_t> m_vPressedKeys;
 };
 
 inline std::unique_ptr<CHyprlock> g_pHyprlock;
@@ -15,6 +15,7 @@ void help() {
                  "  --immediate              - Lock immediately, ignoring any configured grace period\n"
                  "  --immediate-render       - Do not wait for resources before drawing the background\n"
                  "  --no-fade-in             - Disable the fade-in animation when the lock screen appears\n"
+                 "  --daemon                 - Stay resident and lock on `lock` over $XDG_RUNTIME_DIR/hyprlock.sock or SIGRTMIN+1\n"
                  "  -V, --version            - Show version information\n"
                  "  -h, --help               - Show this help message\n";
 }
@@ -34,6 +35,7 @@ int main(int argc, char** argv, char** envp) {
     bool                     immediate       = false;
     bool                     immediateRender = false;
     bool                     noFadeIn        = false;
+    bool                     daemon          = false;
 
     std::vector<std::string> args(argv, argv + argc);
 
@@ -77,6 +79,9 @@ int main(int argc, char** argv, char** envp) {
         else if (arg == "--no-fade-in")
             noFadeIn = true;
 
+        else if (arg == "--daemon")
+            daemon = true;
+
         else {
             std::cerr << "Unknown option: " << arg << "\n";
             help();
@@ -96,7 +101,7 @@ int main(int argc, char** argv, char** envp) {
     }
 
     try {
-        g_pHyprlock = std::make_unique<CHyprlock>(wlDisplay, immediate, immediateRender, noFadeIn);
+        g_pHyprlock = std::make_unique<CHyprlock>(wlDisplay, immediate, immediateRender, noFadeIn, daemon);
         g_pHyprlock->run();
     } catch (const std::exception& ex) {
         Debug::log(CRIT, "Hyprlock threw: {}", ex.what());
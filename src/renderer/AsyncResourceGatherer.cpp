@@ -1,4 +1,5 @@
 #include "AsyncResourceGatherer.hpp"
+#include "Renderer.hpp"
 #include "../config/ConfigManager.hpp"
 #include "../core/Egl.hpp"
 #include <cairo/cairo.h>
@@ -56,7 +57,20 @@ void CAsyncResourceGatherer::enqueueDMAFrames() {
 
         const auto PMONITOR = MON->get();
 
-        dmas.emplace_back(std::make_unique<CDMAFrame>(PMONITOR));
+        // runs on the main thread from the screencopy listener
+        dmas.emplace_back(std::make_unique<CDMAFrame>(PMONITOR, [this]() {
+            std::lock_guard<std::mutex> lg(gatherState.dmasMutex);
+            gatherState.finished++;
+            gatherState.dmasCV.notify_all();
+
+            // the initial gather thread is long gone for recaptures
+            if (!gatherState.recapturing || gatherState.finished < dmas.size())
+                return;
+
+            gatherState.recapturing = false;
+            gathered                = true;
+            g_pHyprlock->renderAllOutputs();
+        }));
     }
 }
 
@@ -130,11 +144,14 @@ void CAsyncResourceGatherer::gather() {
         }
     }
 
-    while (!g_pHyprlock->m_bTerminate && std::any_of(dmas.begin(), dmas.end(), [](const auto& d) { return !d->asset.ready; })) {
-        std::this_thread::sleep_for(std::chrono::milliseconds(1));
-    }
+    std::unique_lock lk(gatherState.dmasMutex);
+    gatherState.dmasCV.wait(lk, [this] { return exiting || gatherState.finished >= dmas.size(); });
+    lk.unlock();
 
     gathered = true;
+
+    // wake the main thread, it might be waiting for us to lock
+    g_pHyprlock->addTask([]() { g_pHyprlock->renderAllOutputs(); }, CEventLoop::WAKEUP_GATHERER);
 }
 
 bool CAsyncResourceGatherer::apply() {
@@ -176,12 +193,20 @@ bool CAsyncResourceGatherer::apply() {
             }
             glTexImage2D(GL_TEXTURE_2D, 0, glIFormat, ASSET->texture.m_vSize.x, ASSET->texture.m_vSize.y, 0, glFormat, glType, t.data);
 
+            // a new texture may get the id of one that was just freed
+            if (g_pRenderer)
+                g_pRenderer->damageTexture(ASSET->texture.m_iTexID);
+
             cairo_destroy((cairo_t*)t.cairo);
             t.cairosurface.reset();
         } else
             Debug::log(ERR, "Unsupported type in ::apply(): {}", (int)t.type);
     }
 
+    // the uploads bound textures without the renderer knowing
+    if (g_pRenderer)
+        g_pRenderer->glState.invalidateTextures();
+
     return true;
 }
 
@@ -218,10 +243,9 @@ void CAsyncResourceGatherer::renderText(const SPreloadRequest& rq) {
     const int          FONTSIZE   = rq.props.contains("font_size") ? std::any_cast<int>(rq.props.at("font_size")) : 16;
     const CColor       FONTCOLOR  = rq.props.contains("color") ? std::any_cast<CColor>(rq.props.at("color")) : CColor(1.0, 1.0, 1.0, 1.0);
     const std::string  FONTFAMILY = rq.props.contains("font_family") ? std::any_cast<std::string>(rq.props.at("font_family")) : "Sans";
-    const bool         ISCMD      = rq.props.contains("cmd") ? std::any_cast<bool>(rq.props.at("cmd")) : false;
 
     static auto* const TRIM = (Hyprlang::INT* const*)g_pConfigManager->getValuePtr("general:text_trim");
-    std::string        TEXT = ISCMD ? g_pHyprlock->spawnSync(rq.asset) : rq.asset;
+    std::string        TEXT = rq.asset;
 
     if (**TRIM) {
         TEXT.erase(0, TEXT.find_first_not_of(" \n\r\t"));
@@ -304,23 +328,12 @@ void CAsyncResourceGatherer::renderText(const SPreloadRequest& rq) {
     preloadTargets.push_back(target);
 }
 
-struct STimerCallbackData {
-    void (*cb)(void*) = nullptr;
-    void* data        = nullptr;
-};
-
-static void timerCallback(std::shared_ptr<CTimer> self, void* data_) {
-    auto data = (STimerCallbackData*)data_;
-    data->cb(data->data);
-    delete data;
-}
-
 void CAsyncResourceGatherer::asyncAssetSpinLock() {
-    while (!g_pHyprlock->m_bTerminate) {
+    while (!exiting) {
 
         std::unique_lock lk(asyncLoopState.requestsMutex);
         if (asyncLoopState.pending == false) // avoid a lock if a thread managed to request something already since we .unlock()ed
-            asyncLoopState.requestsCV.wait_for(lk, std::chrono::seconds(5), [this] { return asyncLoopState.pending; }); // wait for events
+            asyncLoopState.requestsCV.wait(lk, [this] { return asyncLoopState.pending; }); // wait for events, notify() wakes us on exit
 
         asyncLoopState.pending = false;
 
@@ -347,9 +360,9 @@ void CAsyncResourceGatherer::asyncAssetSpinLock() {
                 continue;
             }
 
-            // plant timer for callback
+            // run the callback on the main thread
             if (r.callback)
-                g_pHyprlock->addTimer(std::chrono::milliseconds(0), timerCallback, new STimerCallbackData{r.callback, r.callbackData});
+                g_pHyprlock->addTask([cb = r.callback, data = r.callbackData]() { cb(data); }, CEventLoop::WAKEUP_GATHERER);
         }
     }
 }
@@ -367,11 +380,76 @@ void CAsyncResourceGatherer::unloadAsset(SPreloadedAsset* asset) {
     std::erase_if(assets, [asset](const auto& a) { return &a.second == asset; });
 }
 
+size_t CAsyncResourceGatherer::reloadImage(const std::string& path) {
+    std::vector<std::string> requested;
+
+    // same ids as gather(), widgets pick the new texture up through their asset pointer
+    for (auto& c : g_pConfigManager->getWidgetConfigs()) {
+        if (c.type != "background" && c.type != "image")
+            continue;
+
+        if (std::any_cast<Hyprlang::STRING>(c.values.at("path")) != path)
+            continue;
+
+        const auto ID = c.type + ":" + path;
+        if (std::ranges::find(requested, ID) != requested.end())
+            continue;
+
+        SPreloadRequest rq;
+        rq.type     = TARGET_IMAGE;
+        rq.asset    = path;
+        rq.id       = ID;
+        rq.callback = [](void*) { g_pHyprlock->renderAllOutputs(); };
+
+        requestAsyncAssetPreload(rq);
+        requested.push_back(ID);
+    }
+
+    return requested.size();
+}
+
+size_t CAsyncResourceGatherer::assetCount() {
+    return assets.size();
+}
+
+size_t CAsyncResourceGatherer::assetBytes() {
+    size_t bytes = 0;
+    for (const auto& [id, asset] : assets) {
+        bytes += asset.texture.m_vSize.x * asset.texture.m_vSize.y * 4;
+    }
+
+    return bytes;
+}
+
+void CAsyncResourceGatherer::recaptureScreenshots() {
+    if (!g_pHyprlock->getScreencopy() || !gathered)
+        return;
+
+    {
+        std::lock_guard<std::mutex> lg(gatherState.dmasMutex);
+        gatherState.finished = 0;
+    }
+
+    dmas.clear();
+    enqueueDMAFrames();
+
+    if (dmas.empty())
+        return;
+
+    gatherState.recapturing = true;
+    gathered                = false;
+}
+
 void CAsyncResourceGatherer::notify() {
+    exiting = true;
+
     std::lock_guard<std::mutex> lg(asyncLoopState.requestsMutex);
     asyncLoopState.requests.clear();
     asyncLoopState.pending = true;
     asyncLoopState.requestsCV.notify_all();
+
+    std::lock_guard<std::mutex> lg2(gatherState.dmasMutex);
+    gatherState.dmasCV.notify_all();
 }
 
 void CAsyncResourceGatherer::await() {
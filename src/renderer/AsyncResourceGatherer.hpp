@@ -41,10 +41,20 @@ class CAsyncResourceGatherer {
         void* callbackData      = nullptr;
     };
 
-    void requestAsyncAssetPreload(const SPreloadRequest& request);
-    void unloadAsset(SPreloadedAsset* asset);
-    void notify();
-    void await();
+    void   requestAsyncAssetPreload(const SPreloadRequest& request);
+    void   unloadAsset(SPreloadedAsset* asset);
+    // Decodes the image at path again for the backgrounds and images configured with it, e.g. after it changed on disk.
+    // Returns how many assets were requested.
+    size_t reloadImage(const std::string& path);
+    // Takes new screenshots for screenshot backgrounds. gathered is false until they are in.
+    void   recaptureScreenshots();
+    // Stops the gatherer threads, await() joins them
+    void   notify();
+    void   await();
+
+    // loaded assets and their texture memory, main thread only
+    size_t assetCount();
+    size_t assetBytes();
 
   private:
     std::thread asyncLoopThread;
@@ -77,6 +87,16 @@ class CAsyncResourceGatherer {
 
     std::vector<std::unique_ptr<CDMAFrame>>          dmas;
 
+    struct {
+        std::condition_variable dmasCV;
+        std::mutex              dmasMutex;
+        size_t                  finished = 0;
+        // main thread only
+        bool                    recapturing = false;
+    } gatherState;
+
+    std::atomic<bool>                                exiting = false;
+
     std::vector<SPreloadTarget>                      preloadTargets;
     std::mutex                                       preloadTargetsMutex;
 
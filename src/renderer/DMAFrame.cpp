@@ -1,4 +1,5 @@
 #include "DMAFrame.hpp"
+#include "Renderer.hpp"
 #include "linux-dmabuf-unstable-v1-protocol.h"
 #include "wlr-screencopy-unstable-v1-protocol.h"
 #include "../helpers/Log.hpp"
@@ -35,14 +36,24 @@ static void wlrOnReady(void* data, zwlr_screencopy_frame_v1* frame, uint32_t tv_
 
     if (!PDATA->frame->onBufferReady()) {
         Debug::log(ERR, "onBufferReady failed");
+        zwlr_screencopy_frame_v1_destroy(frame);
+        PDATA->frame->finish();
         return;
     }
 
     zwlr_screencopy_frame_v1_destroy(frame);
+
+    PDATA->frame->finish();
 }
 
 static void wlrOnFailed(void* data, zwlr_screencopy_frame_v1* frame) {
-    ;
+    const auto PDATA = (SScreencopyData*)data;
+
+    Debug::log(ERR, "[sc] wlrOnFailed for {}", (void*)PDATA);
+
+    // the listener data is freed along with the frame, the proxy must not outlive it
+    zwlr_screencopy_frame_v1_destroy(frame);
+    PDATA->frame->finish();
 }
 
 static void wlrOnDamage(void* data, zwlr_screencopy_frame_v1* frame, uint32_t x, uint32_t y, uint32_t width, uint32_t height) {
@@ -68,6 +79,8 @@ static void wlrOnBufferDone(void* data, zwlr_screencopy_frame_v1* frame) {
 
     if (!PDATA->frame->onBufferDone()) {
         Debug::log(ERR, "onBufferDone failed");
+        zwlr_screencopy_frame_v1_destroy(frame);
+        PDATA->frame->finish();
         return;
     }
 
@@ -90,13 +103,14 @@ std::string CDMAFrame::getResourceId(COutput* output) {
     return std::format("dma:{}-{}x{}", output->stringPort, output->size.x, output->size.y);
 }
 
-CDMAFrame::CDMAFrame(COutput* output_) {
+CDMAFrame::CDMAFrame(COutput* output_, std::function<void()> onFinished) : finishedCallback(onFinished) {
     resourceID = getResourceId(output_);
 
     if (!glEGLImageTargetTexture2DOES) {
         glEGLImageTargetTexture2DOES = (PFNGLEGLIMAGETARGETTEXTURE2DOESPROC)eglGetProcAddress("glEGLImageTargetTexture2DOES");
         if (!glEGLImageTargetTexture2DOES) {
             Debug::log(ERR, "No glEGLImageTargetTexture2DOES??");
+            finish();
             return;
         }
     }
@@ -113,10 +127,27 @@ CDMAFrame::CDMAFrame(COutput* output_) {
 }
 
 CDMAFrame::~CDMAFrame() {
-    if (g_pEGL)
+    if (g_pEGL && image)
         eglDestroyImage(g_pEGL->eglDisplay, image);
 
-    // leaks bo and stuff but lives throughout so for now who cares
+    // the daemon recaptures on every lock, so don't leak the buffers
+    if (wlBuffer)
+        wl_buffer_destroy(wlBuffer);
+
+    for (size_t plane = 0; plane < (size_t)planes; plane++)
+        close(fd[plane]);
+
+    if (bo)
+        gbm_bo_destroy(bo);
+}
+
+void CDMAFrame::finish() {
+    if (!finishedCallback)
+        return;
+
+    const auto CB    = finishedCallback;
+    finishedCallback = nullptr;
+    CB();
 }
 
 bool CDMAFrame::onBufferDone() {
@@ -169,6 +200,8 @@ bool CDMAFrame::onBufferDone() {
     if (!params) {
         Debug::log(ERR, "zwp_linux_dmabuf_v1_create_params failed");
         gbm_bo_destroy(bo);
+        bo     = nullptr;
+        planes = 0;
         return false;
     }
 
@@ -182,9 +215,11 @@ bool CDMAFrame::onBufferDone() {
             Debug::log(ERR, "gbm_bo_get_fd_for_plane failed");
             zwp_linux_buffer_params_v1_destroy(params);
             gbm_bo_destroy(bo);
+            bo = nullptr;
             for (size_t plane_tmp = 0; plane_tmp < plane; plane_tmp++) {
                 close(fd[plane_tmp]);
             }
+            planes = 0;
             return false;
         }
 
@@ -197,8 +232,10 @@ bool CDMAFrame::onBufferDone() {
     if (!wlBuffer) {
         Debug::log(ERR, "[pw] zwp_linux_buffer_params_v1_create_immed failed");
         gbm_bo_destroy(bo);
+        bo = nullptr;
         for (size_t plane = 0; plane < (size_t)planes; plane++)
             close(fd[plane]);
+        planes = 0;
 
         return false;
     }
@@ -244,6 +281,10 @@ bool CDMAFrame::onBufferReady() {
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
     glEGLImageTargetTexture2DOES(GL_TEXTURE_2D, image);
     glBindTexture(GL_TEXTURE_2D, 0);
+    if (g_pRenderer) {
+        g_pRenderer->glState.invalidateTextures();
+        g_pRenderer->damageTexture(asset.texture.m_iTexID);
+    }
 
     Debug::log(LOG, "Got dma frame with size {}", size);
 
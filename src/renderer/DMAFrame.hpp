@@ -3,6 +3,7 @@
 #include "../core/Output.hpp"
 #include <gbm.h>
 #include "Shared.hpp"
+#include <functional>
 
 struct zwlr_screencopy_frame_v1;
 
@@ -20,11 +21,13 @@ class CDMAFrame {
   public:
     static std::string getResourceId(COutput* output);
 
-    CDMAFrame(COutput* mon);
+    // onFinished fires once, on the main thread, when the frame is either ready or failed
+    CDMAFrame(COutput* mon, std::function<void()> onFinished);
     ~CDMAFrame();
 
     bool            onBufferDone();
     bool            onBufferReady();
+    void            finish();
 
     wl_buffer*      wlBuffer = nullptr;
 
@@ -44,4 +47,6 @@ class CDMAFrame {
     SScreencopyData           scdata;
 
     EGLImage                  image = nullptr;
+
+    std::function<void()>     finishedCallback;
 };
\ No newline at end of file
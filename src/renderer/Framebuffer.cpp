@@ -1,4 +1,5 @@
 #include "Framebuffer.hpp"
+#include "Renderer.hpp"
 #include "../helpers/Log.hpp"
 #include <libdrm/drm_fourcc.h>
 
@@ -66,6 +67,8 @@ bool CFramebuffer::alloc(int w, int h, bool highres) {
 
     glBindTexture(GL_TEXTURE_2D, 0);
     glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    if (g_pRenderer)
+        g_pRenderer->glState.invalidateTextures();
 
     m_vSize = Vector2D(w, h);
 
@@ -90,6 +93,8 @@ void CFramebuffer::addStencil() {
 
     glBindTexture(GL_TEXTURE_2D, 0);
     glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    if (g_pRenderer)
+        g_pRenderer->glState.invalidateTextures();
 }
 
 void CFramebuffer::bind() const {
@@ -0,0 +1,112 @@
+#include "FramebufferPool.hpp"
+#include "../core/hyprlock.hpp"
+#include <algorithm>
+#include <format>
+#include <optional>
+
+// two sets of 4K RGBA16F blur targets
+constexpr size_t MAXFREEBYTES = 256 * 1024 * 1024;
+// blurs mostly run right after locking, the targets are not worth keeping for the rest of it
+constexpr auto MAXIDLE = std::chrono::seconds(10);
+
+static size_t fbBytes(const CFramebuffer& fb, bool highres) {
+    return (size_t)fb.m_vSize.x * fb.m_vSize.y * (highres ? 8 : 4);
+}
+
+CFramebufferPool::~CFramebufferPool() {
+    if (m_pTrimTimer)
+        m_pTrimTimer->cancel();
+}
+
+CFramebuffer* CFramebufferPool::acquire(const Vector2D& size, bool highres) {
+    m_iAcquired++;
+
+    for (auto& e : m_vEntries) {
+        if (e.inUse || e.highres != highres || e.fb->m_vSize != size)
+            continue;
+
+        e.inUse = true;
+        return e.fb.get();
+    }
+
+    m_iAllocated++;
+
+    auto& e   = m_vEntries.emplace_back();
+    e.fb      = allocate(size, highres);
+    e.highres = highres;
+    e.inUse   = true;
+
+    return e.fb.get();
+}
+
+void CFramebufferPool::release(CFramebuffer* fb) {
+    const auto IT = std::ranges::find_if(m_vEntries, [fb](const auto& e) { return e.fb.get() == fb; });
+    if (IT == m_vEntries.end())
+        return;
+
+    IT->inUse    = false;
+    IT->lastUsed = std::chrono::steady_clock::now();
+
+    trim(IT->lastUsed);
+}
+
+std::unique_ptr<CFramebuffer> CFramebufferPool::allocate(const Vector2D& size, bool highres) {
+    auto fb = std::make_unique<CFramebuffer>();
+    fb->alloc(size.x, size.y, highres);
+    return fb;
+}
+
+void CFramebufferPool::trim(const std::chrono::steady_clock::time_point& now) {
+    std::erase_if(m_vEntries, [now](const auto& e) { return !e.inUse && now - e.lastUsed >= MAXIDLE; });
+
+    size_t freeBytes = 0;
+    for (const auto& e : m_vEntries) {
+        if (!e.inUse)
+            freeBytes += fbBytes(*e.fb, e.highres);
+    }
+
+    while (freeBytes > MAXFREEBYTES) {
+        auto oldest = m_vEntries.end();
+        for (auto it = m_vEntries.begin(); it != m_vEntries.end(); ++it) {
+            if (!it->inUse && (oldest == m_vEntries.end() || it->lastUsed < oldest->lastUsed))
+                oldest = it;
+        }
+
+        freeBytes -= fbBytes(*oldest->fb, oldest->highres);
+        m_vEntries.erase(oldest);
+    }
+
+    std::optional<std::chrono::steady_clock::time_point> oldestFree;
+    for (const auto& e : m_vEntries) {
+        if (!e.inUse && (!oldestFree || e.lastUsed < *oldestFree))
+            oldestFree = e.lastUsed;
+    }
+
+    // nothing may be drawn for a long time, so the next one to go idle is freed by a timer
+    if (oldestFree)
+        armTrimTimer(*oldestFree + MAXIDLE);
+}
+
+void CFramebufferPool::armTrimTimer(const std::chrono::steady_clock::time_point& at) {
+    const auto TIMEOUT = at - std::chrono::steady_clock::now();
+
+    if (!m_pTrimTimer)
+        m_pTrimTimer = g_pHyprlock->addTimer(
+            TIMEOUT, [](std::shared_ptr<CTimer>, void* data) { ((CFramebufferPool*)data)->trim(std::chrono::steady_clock::now()); }, this, false, std::chrono::seconds(1));
+    // only move it if it would fire too late or not at all
+    else if (m_pTrimTimer->passed() || m_pTrimTimer->cancelled() || at < m_pTrimTimer->expiresAt())
+        g_pHyprlock->rearmTimer(m_pTrimTimer, TIMEOUT);
+}
+
+void CFramebufferPool::clear() {
+    std::erase_if(m_vEntries, [](const auto& e) { return !e.inUse; });
+}
+
+std::string CFramebufferPool::stats() const {
+    size_t bytes = 0;
+    for (const auto& e : m_vEntries) {
+        bytes += fbBytes(*e.fb, e.highres);
+    }
+
+    return std::format("framebuffer pool: {} framebuffers ({} KiB), {} allocated for {} acquired", m_vEntries.size(), bytes / 1024, m_iAllocated, m_iAcquired);
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include "Framebuffer.hpp"
+#include "../core/Timer.hpp"
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Framebuffers only needed while drawing something, like the ping-pong targets of a blur.
+// Released ones are kept for the next acquire of the same size and format, on any output.
+// Free ones beyond a memory budget or unused for a while are freed, least recently used first.
+class CFramebufferPool {
+  public:
+    virtual ~CFramebufferPool();
+
+    // a free framebuffer of that size and format, allocated if there is none. Its contents are undefined
+    CFramebuffer* acquire(const Vector2D& size, bool highres);
+    void          release(CFramebuffer* fb);
+
+    // frees all free framebuffers
+    void          clear();
+
+    std::string   stats() const;
+
+  protected:
+    // GL allocations and the trim timer, the tests replace both
+    virtual std::unique_ptr<CFramebuffer> allocate(const Vector2D& size, bool highres);
+    virtual void                          armTrimTimer(const std::chrono::steady_clock::time_point& at);
+
+    // frees what is over budget or was unused for too long by now
+    void                                  trim(const std::chrono::steady_clock::time_point& now);
+
+  private:
+    struct SEntry {
+        std::unique_ptr<CFramebuffer>         fb;
+        bool                                  highres = false;
+        bool                                  inUse   = false;
+        std::chrono::steady_clock::time_point lastUsed;
+    };
+
+    std::vector<SEntry>     m_vEntries;
+    std::shared_ptr<CTimer> m_pTrimTimer;
+
+    uint64_t                m_iAcquired  = 0;
+    uint64_t                m_iAllocated = 0;
+};
@@ -0,0 +1,141 @@
+#include "GLState.hpp"
+#include <cstring>
+#include <format>
+
+bool CGLState::count(eCallKind kind, bool changed) {
+    m_aCalls[kind].requested++;
+    if (changed)
+        m_aCalls[kind].issued++;
+
+    return changed;
+}
+
+void CGLState::useProgram(GLuint program, GLuint vao) {
+    if (count(CALL_PROGRAM, m_iProgram != program)) {
+        glUseProgram(program);
+        m_iProgram = program;
+    }
+
+    if (count(CALL_PROGRAM, m_iVAO != vao)) {
+        glBindVertexArray(vao);
+        m_iVAO = vao;
+    }
+}
+
+void CGLState::bindTexture(GLenum target, GLuint texture) {
+    const auto IT = m_mTextures.find(target);
+    if (!count(CALL_TEXTURE, IT == m_mTextures.end() || IT->second != texture))
+        return;
+
+    glBindTexture(target, texture);
+    m_mTextures[target] = texture;
+}
+
+void CGLState::invalidateTextures() {
+    m_mTextures.clear();
+}
+
+void CGLState::invalidateProgram() {
+    m_iProgram.reset();
+    m_iVAO.reset();
+}
+
+void CGLState::setCapability(GLenum cap, bool enabled) {
+    const auto IT = m_mCapabilities.find(cap);
+    if (!count(CALL_CAPABILITY, IT == m_mCapabilities.end() || IT->second != enabled))
+        return;
+
+    if (enabled)
+        glEnable(cap);
+    else
+        glDisable(cap);
+
+    m_mCapabilities[cap] = enabled;
+}
+
+void CGLState::blendFunc(GLenum src, GLenum dst) {
+    if (!count(CALL_CAPABILITY, m_blendFunc != std::pair{src, dst}))
+        return;
+
+    glBlendFunc(src, dst);
+    m_blendFunc = std::pair{src, dst};
+}
+
+void CGLState::scissor(GLint x, GLint y, GLsizei w, GLsizei h) {
+    const std::array<GLint, 4> BOX = {x, y, w, h};
+    if (!count(CALL_CAPABILITY, m_scissor != BOX))
+        return;
+
+    glScissor(x, y, w, h);
+    m_scissor = BOX;
+}
+
+std::optional<std::array<GLint, 4>> CGLState::scissorBox() const {
+    const auto IT = m_mCapabilities.find(GL_SCISSOR_TEST);
+    if (IT == m_mCapabilities.end() || !IT->second)
+        return std::nullopt;
+
+    return m_scissor;
+}
+
+bool CGLState::uniformChanged(GLint location, const void* data, size_t size) {
+    // -1 is a uniform the program doesn't have, GL ignores it anyway
+    if (location < 0)
+        return false;
+
+    if (!m_iProgram)
+        return true;
+
+    // values stay with the program, so they are remembered per program
+    auto& last = m_mUniforms[((uint64_t)*m_iProgram << 32) | (uint32_t)location];
+    if (last.size() == size && std::memcmp(last.data(), data, size) == 0)
+        return false;
+
+    last.assign((const char*)data, (const char*)data + size);
+    return true;
+}
+
+void CGLState::uniform1i(GLint location, GLint v) {
+    if (count(CALL_UNIFORM, uniformChanged(location, &v, sizeof(v))))
+        glUniform1i(location, v);
+}
+
+void CGLState::uniform1f(GLint location, GLfloat v) {
+    if (count(CALL_UNIFORM, uniformChanged(location, &v, sizeof(v))))
+        glUniform1f(location, v);
+}
+
+void CGLState::uniform2f(GLint location, GLfloat x, GLfloat y) {
+    const GLfloat V[] = {x, y};
+    if (count(CALL_UNIFORM, uniformChanged(location, V, sizeof(V))))
+        glUniform2f(location, x, y);
+}
+
+void CGLState::uniform3f(GLint location, GLfloat x, GLfloat y, GLfloat z) {
+    const GLfloat V[] = {x, y, z};
+    if (count(CALL_UNIFORM, uniformChanged(location, V, sizeof(V))))
+        glUniform3f(location, x, y, z);
+}
+
+void CGLState::uniform4f(GLint location, GLfloat x, GLfloat y, GLfloat z, GLfloat w) {
+    const GLfloat V[] = {x, y, z, w};
+    if (count(CALL_UNIFORM, uniformChanged(location, V, sizeof(V))))
+        glUniform4f(location, x, y, z, w);
+}
+
+void CGLState::uniform4fv(GLint location, GLsizei vecCount, const GLfloat* v) {
+    if (count(CALL_UNIFORM, uniformChanged(location, v, sizeof(GLfloat) * 4 * vecCount)))
+        glUniform4fv(location, vecCount, v);
+}
+
+void CGLState::uniformMatrix3fv(GLint location, const GLfloat* m) {
+    if (count(CALL_UNIFORM, uniformChanged(location, m, sizeof(GLfloat) * 9)))
+        glUniformMatrix3fv(location, 1, GL_TRUE, m);
+}
+
+std::string CGLState::stats() const {
+    const auto FORMAT = [this](eCallKind kind) { return std::format("{}/{}", m_aCalls[kind].issued, m_aCalls[kind].requested); };
+
+    return std::format("gl calls issued/requested: programs {}, textures {}, capabilities {}, uniforms {}", FORMAT(CALL_PROGRAM), FORMAT(CALL_TEXTURE),
+                       FORMAT(CALL_CAPABILITY), FORMAT(CALL_UNIFORM));
+}
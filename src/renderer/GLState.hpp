@@ -0,0 +1,72 @@
+#pragma once
+
+#include <GLES3/gl32.h>
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Remembers the GL state set through it and drops calls that would not change anything.
+// Code that changes the same state behind its back has to invalidate it, or a needed call may be dropped.
+// Everything is drawn with texture unit 0, which is never changed.
+class CGLState {
+  public:
+    void        useProgram(GLuint program, GLuint vao);
+    void        bindTexture(GLenum target, GLuint texture);
+    void        setCapability(GLenum cap, bool enabled);
+    void        blendFunc(GLenum src, GLenum dst);
+    void        scissor(GLint x, GLint y, GLsizei w, GLsizei h);
+
+    // of the program in use
+    void        uniform1i(GLint location, GLint v);
+    void        uniform1f(GLint location, GLfloat v);
+    void        uniform2f(GLint location, GLfloat x, GLfloat y);
+    void        uniform3f(GLint location, GLfloat x, GLfloat y, GLfloat z);
+    void        uniform4f(GLint location, GLfloat x, GLfloat y, GLfloat z, GLfloat w);
+    void        uniform4fv(GLint location, GLsizei vecCount, const GLfloat* v);
+    // row major, uploaded transposed
+    void        uniformMatrix3fv(GLint location, const GLfloat* m);
+
+    // the scissor box if the scissor test is on
+    std::optional<std::array<GLint, 4>> scissorBox() const;
+
+    // after textures were bound directly, e.g. to upload them
+    void        invalidateTextures();
+    // after a program or vertex array was bound directly
+    void        invalidateProgram();
+
+    // requested and actually issued calls per kind, for the metrics command
+    std::string stats() const;
+
+  private:
+    enum eCallKind : uint8_t {
+        CALL_PROGRAM = 0,
+        CALL_TEXTURE,
+        CALL_CAPABILITY,
+        CALL_UNIFORM,
+        CALL_KIND_COUNT,
+    };
+
+    struct SCallCount {
+        uint64_t requested = 0;
+        uint64_t issued    = 0;
+    };
+
+    // counts the call, true if it has to be made
+    bool                                            count(eCallKind kind, bool changed);
+    // compares with and stores the last value of the location for the program in use
+    bool                                            uniformChanged(GLint location, const void* data, size_t size);
+
+    std::optional<GLuint>                           m_iProgram;
+    std::optional<GLuint>                           m_iVAO;
+    std::unordered_map<GLenum, GLuint>              m_mTextures;
+    std::unordered_map<GLenum, bool>                m_mCapabilities;
+    std::optional<std::pair<GLenum, GLenum>>        m_blendFunc;
+    std::optional<std::array<GLint, 4>>             m_scissor;
+    std::unordered_map<uint64_t, std::vector<char>> m_mUniforms;
+
+    std::array<SCallCount, CALL_KIND_COUNT>         m_aCalls;
+};
@@ -0,0 +1,119 @@
+#include "ProgramCache.hpp"
+#include "../helpers/Log.hpp"
+#include <format>
+#include <fstream>
+#include <vector>
+#include <unistd.h>
+
+// stable across builds, unlike std::hash
+static uint64_t fnv1a(const std::string& str, uint64_t hash = 0xcbf29ce484222325ULL) {
+    for (const auto& c : str) {
+        hash ^= (uint8_t)c;
+        hash *= 0x100000001b3ULL;
+    }
+
+    return hash;
+}
+
+static std::string glString(GLenum name) {
+    const auto STR = (const char*)glGetString(name);
+    return STR ? STR : "";
+}
+
+CProgramCache::CProgramCache() {
+    GLint formats = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+    if (formats <= 0) {
+        Debug::log(LOG, "[shaders] The driver has no program binary formats, not caching programs");
+        return;
+    }
+
+    const auto CACHEHOME = getenv("XDG_CACHE_HOME");
+    const auto HOME      = getenv("HOME");
+    if (CACHEHOME && CACHEHOME[0] != '\0')
+        m_pCacheDir = std::filesystem::path{CACHEHOME} / "hyprlock";
+    else if (HOME)
+        m_pCacheDir = std::filesystem::path{HOME} / ".cache" / "hyprlock";
+    else
+        return;
+
+    std::error_code ec;
+    std::filesystem::create_directories(m_pCacheDir, ec);
+    if (ec) {
+        Debug::log(WARN, "[shaders] Can't create {}: {}", m_pCacheDir.string(), ec.message());
+        return;
+    }
+
+    m_szDriver = glString(GL_VENDOR) + "\n" + glString(GL_RENDERER) + "\n" + glString(GL_VERSION);
+    m_bEnabled = true;
+}
+
+std::filesystem::path CProgramCache::entryPath(const std::string& vert, const std::string& frag) {
+    const auto HASH = fnv1a(frag, fnv1a(vert, fnv1a(m_szDriver)));
+    return m_pCacheDir / std::format("{:016x}.bin", HASH);
+}
+
+GLuint CProgramCache::load(const std::string& vert, const std::string& frag) {
+    if (!m_bEnabled)
+        return 0;
+
+    std::ifstream file(entryPath(vert, frag), std::ios::binary);
+    if (!file.good())
+        return 0;
+
+    GLenum format = 0;
+    if (!file.read((char*)&format, sizeof(format)))
+        return 0;
+
+    const std::vector<char> BINARY((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    if (BINARY.empty())
+        return 0;
+
+    const auto PROG = glCreateProgram();
+    glProgramBinary(PROG, format, BINARY.data(), BINARY.size());
+
+    // the driver may reject binaries of an older build of itself, even with the same version string
+    GLint ok = GL_FALSE;
+    glGetProgramiv(PROG, GL_LINK_STATUS, &ok);
+    if (ok == GL_FALSE) {
+        Debug::log(LOG, "[shaders] Cached program {} was rejected, compiling", entryPath(vert, frag).filename().string());
+        glDeleteProgram(PROG);
+        return 0;
+    }
+
+    return PROG;
+}
+
+void CProgramCache::store(GLuint program, const std::string& vert, const std::string& frag) {
+    if (!m_bEnabled)
+        return;
+
+    GLint length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0)
+        return;
+
+    std::vector<char> binary(length);
+    GLenum            format = 0;
+    glGetProgramBinary(program, length, &length, &format, binary.data());
+    if (length <= 0)
+        return;
+
+    // write and rename, so a crash or a second instance never leaves a half written entry behind
+    const auto    PATH = entryPath(vert, frag);
+    const auto    TMP  = PATH.string() + std::format(".{}.tmp", getpid());
+
+    std::ofstream file(TMP, std::ios::binary | std::ios::trunc);
+    file.write((const char*)&format, sizeof(format));
+    file.write(binary.data(), length);
+    file.close();
+
+    std::error_code ec;
+    if (file.fail())
+        std::filesystem::remove(TMP, ec);
+    else
+        std::filesystem::rename(TMP, PATH, ec);
+
+    if (ec || file.fail())
+        Debug::log(WARN, "[shaders] Failed to cache a program in {}", m_pCacheDir.string());
+}
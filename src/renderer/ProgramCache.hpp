@@ -0,0 +1,25 @@
+#pragma once
+
+#include <GLES3/gl32.h>
+#include <filesystem>
+#include <string>
+
+// Linked programs from glGetProgramBinary, kept in $XDG_CACHE_HOME/hyprlock so later starts skip compiling.
+// Entries are keyed on the shader sources and the GL vendor, renderer and version, so a driver update just misses.
+// Anything unusable is a miss, the caller compiles as usual. Needs a current context.
+class CProgramCache {
+  public:
+    CProgramCache();
+
+    // 0 if nothing usable is cached
+    GLuint                load(const std::string& vert, const std::string& frag);
+    // the program must have been linked with GL_PROGRAM_BINARY_RETRIEVABLE_HINT
+    void                  store(GLuint program, const std::string& vert, const std::string& frag);
+
+  private:
+    std::filesystem::path entryPath(const std::string& vert, const std::string& frag);
+
+    std::filesystem::path m_pCacheDir;
+    std::string           m_szDriver;
+    bool                  m_bEnabled = false;
+};
@@ -7,8 +7,10 @@
 #include "../renderer/DMAFrame.hpp"
 #include <GLES3/gl32.h>
 #include <GLES3/gl3ext.h>
+#include <GLES2/gl2ext.h>
 #include <algorithm>
 #include "Shaders.hpp"
+#include "ProgramCache.hpp"
 #include "src/helpers/Log.hpp"
 #include "widgets/PasswordInputField.hpp"
 #include "widgets/Background.hpp"
@@ -23,7 +25,8 @@ inline const float fullVerts[] = {
     0, 1, // bottom left
 };
 
-GLuint compileShader(const GLuint& type, std::string src) {
+// only starts compiling, the status is checked in CRenderer::finishProgram
+static GLuint compileShader(const GLuint& type, const std::string& src) {
     auto shader = glCreateShader(type);
 
     auto shaderSource = src.c_str();
@@ -31,39 +34,51 @@ GLuint compileShader(const GLuint& type, std::string src) {
     glShaderSource(shader, 1, (const GLchar**)&shaderSource, nullptr);
     glCompileShader(shader);
 
-    GLint ok;
-    glGetShaderiv(shader, GL_COMPILE_STATUS, &ok);
-
-    RASSERT(ok != GL_FALSE, "compileShader() failed! GL_COMPILE_STATUS not OK!");
-
     return shader;
 }
 
-GLuint createProgram(const std::string& vert, const std::string& frag) {
-    auto vertCompiled = compileShader(GL_VERTEX_SHADER, vert);
+struct SNeededPrograms {
+    bool blur        = false;
+    bool border      = false;
+    bool dotRects    = false;
+    bool dotTextures = false;
+};
 
-    RASSERT(vertCompiled, "Compiling shader failed. VERTEX NULL! Shader source:\n\n{}", vert.c_str());
+// which of the optional programs the configured widgets draw with
+static SNeededPrograms neededPrograms() {
+    SNeededPrograms needed;
 
-    auto fragCompiled = compileShader(GL_FRAGMENT_SHADER, frag);
+    for (const auto& c : g_pConfigManager->getWidgetConfigs()) {
+        const auto INT = [&c](const std::string& key) -> Hyprlang::INT { return c.values.contains(key) ? std::any_cast<Hyprlang::INT>(c.values.at(key)) : 0; };
 
-    RASSERT(fragCompiled, "Compiling shader failed. FRAGMENT NULL! Shader source:\n\n{}", frag.c_str());
+        if (INT("shadow_passes") > 0 || (c.type == "background" && INT("blur_passes") > 0))
+            needed.blur = true;
 
-    auto prog = glCreateProgram();
-    glAttachShader(prog, vertCompiled);
-    glAttachShader(prog, fragCompiled);
-    glLinkProgram(prog);
+        if ((c.type == "input-field" && INT("outline_thickness") > 0) || ((c.type == "shape" || c.type == "image") && INT("border_size") > 0))
+            needed.border = true;
 
-    glDetachShader(prog, vertCompiled);
-    glDetachShader(prog, fragCompiled);
-    glDeleteShader(vertCompiled);
-    glDeleteShader(fragCompiled);
-
-    GLint ok;
-    glGetProgramiv(prog, GL_LINK_STATUS, &ok);
+        if (c.type == "input-field") {
+            const std::string DOTSTEXT = std::any_cast<Hyprlang::STRING>(c.values.at("dots_text_format"));
+            if (DOTSTEXT.empty())
+                needed.dotRects = true;
+            else
+                needed.dotTextures = true;
+        }
+    }
 
-    RASSERT(ok != GL_FALSE, "createProgram() failed! GL_LINK_STATUS not OK!");
+    return needed;
+}
 
-    return prog;
+static void getInstancedLocations(CShader& shader) {
+    shader.fullSize              = glGetUniformLocation(shader.program, "fullSize");
+    shader.radius                = glGetUniformLocation(shader.program, "radius");
+    shader.posAttrib             = glGetAttribLocation(shader.program, "pos");
+    shader.texAttrib             = glGetAttribLocation(shader.program, "texcoord");
+    shader.instanceRowAttribs[0] = glGetAttribLocation(shader.program, "instanceRow0");
+    shader.instanceRowAttribs[1] = glGetAttribLocation(shader.program, "instanceRow1");
+    shader.instanceRowAttribs[2] = glGetAttribLocation(shader.program, "instanceRow2");
+    shader.instanceTopLeftAttrib = glGetAttribLocation(shader.program, "instanceTopLeft");
+    shader.instanceAlphaAttrib   = glGetAttribLocation(shader.program, "instanceAlpha");
 }
 
 static void glMessageCallbackA(GLenum source, GLenum type, GLuint id, GLenum severity, GLsizei length, const GLchar* message, const void* userParam) {
@@ -78,100 +93,284 @@ CRenderer::CRenderer() {
     glEnable(GL_DEBUG_OUTPUT);
     glDebugMessageCallback(glMessageCallbackA, 0);
 
-    GLuint prog          = createProgram(QUADVERTSRC, QUADFRAGSRC);
-    rectShader.program   = prog;
-    rectShader.proj      = glGetUniformLocation(prog, "proj");
-    rectShader.color     = glGetUniformLocation(prog, "color");
-    rectShader.posAttrib = glGetAttribLocation(prog, "pos");
-    rectShader.topLeft   = glGetUniformLocation(prog, "topLeft");
-    rectShader.fullSize  = glGetUniformLocation(prog, "fullSize");
-    rectShader.radius    = glGetUniformLocation(prog, "radius");
-
-    prog                        = createProgram(TEXVERTSRC, TEXFRAGSRCRGBA);
-    texShader.program           = prog;
-    texShader.proj              = glGetUniformLocation(prog, "proj");
-    texShader.tex               = glGetUniformLocation(prog, "tex");
-    texShader.alphaMatte        = glGetUniformLocation(prog, "texMatte");
-    texShader.alpha             = glGetUniformLocation(prog, "alpha");
-    texShader.texAttrib         = glGetAttribLocation(prog, "texcoord");
-    texShader.matteTexAttrib    = glGetAttribLocation(prog, "texcoordMatte");
-    texShader.posAttrib         = glGetAttribLocation(prog, "pos");
-    texShader.discardOpaque     = glGetUniformLocation(prog, "discardOpaque");
-    texShader.discardAlpha      = glGetUniformLocation(prog, "discardAlpha");
-    texShader.discardAlphaValue = glGetUniformLocation(prog, "discardAlphaValue");
-    texShader.topLeft           = glGetUniformLocation(prog, "topLeft");
-    texShader.fullSize          = glGetUniformLocation(prog, "fullSize");
-    texShader.radius            = glGetUniformLocation(prog, "radius");
-    texShader.applyTint         = glGetUniformLocation(prog, "applyTint");
-    texShader.tint              = glGetUniformLocation(prog, "tint");
-    texShader.useAlphaMatte     = glGetUniformLocation(prog, "useAlphaMatte");
-
-    prog                          = createProgram(TEXVERTSRC, FRAGBLUR1);
-    blurShader1.program           = prog;
-    blurShader1.tex               = glGetUniformLocation(prog, "tex");
-    blurShader1.alpha             = glGetUniformLocation(prog, "alpha");
-    blurShader1.proj              = glGetUniformLocation(prog, "proj");
-    blurShader1.posAttrib         = glGetAttribLocation(prog, "pos");
-    blurShader1.texAttrib         = glGetAttribLocation(prog, "texcoord");
-    blurShader1.radius            = glGetUniformLocation(prog, "radius");
-    blurShader1.halfpixel         = glGetUniformLocation(prog, "halfpixel");
-    blurShader1.passes            = glGetUniformLocation(prog, "passes");
-    blurShader1.vibrancy          = glGetUniformLocation(prog, "vibrancy");
-    blurShader1.vibrancy_darkness = glGetUniformLocation(prog, "vibrancy_darkness");
-
-    prog                  = createProgram(TEXVERTSRC, FRAGBLUR2);
-    blurShader2.program   = prog;
-    blurShader2.tex       = glGetUniformLocation(prog, "tex");
-    blurShader2.alpha     = glGetUniformLocation(prog, "alpha");
-    blurShader2.proj      = glGetUniformLocation(prog, "proj");
-    blurShader2.posAttrib = glGetAttribLocation(prog, "pos");
-    blurShader2.texAttrib = glGetAttribLocation(prog, "texcoord");
-    blurShader2.radius    = glGetUniformLocation(prog, "radius");
-    blurShader2.halfpixel = glGetUniformLocation(prog, "halfpixel");
-
-    prog                         = createProgram(TEXVERTSRC, FRAGBLURPREPARE);
-    blurPrepareShader.program    = prog;
-    blurPrepareShader.tex        = glGetUniformLocation(prog, "tex");
-    blurPrepareShader.proj       = glGetUniformLocation(prog, "proj");
-    blurPrepareShader.posAttrib  = glGetAttribLocation(prog, "pos");
-    blurPrepareShader.texAttrib  = glGetAttribLocation(prog, "texcoord");
-    blurPrepareShader.contrast   = glGetUniformLocation(prog, "contrast");
-    blurPrepareShader.brightness = glGetUniformLocation(prog, "brightness");
-
-    prog                          = createProgram(TEXVERTSRC, FRAGBLURFINISH);
-    blurFinishShader.program      = prog;
-    blurFinishShader.tex          = glGetUniformLocation(prog, "tex");
-    blurFinishShader.proj         = glGetUniformLocation(prog, "proj");
-    blurFinishShader.posAttrib    = glGetAttribLocation(prog, "pos");
-    blurFinishShader.texAttrib    = glGetAttribLocation(prog, "texcoord");
-    blurFinishShader.brightness   = glGetUniformLocation(prog, "brightness");
-    blurFinishShader.noise        = glGetUniformLocation(prog, "noise");
-    blurFinishShader.colorize     = glGetUniformLocation(prog, "colorize");
-    blurFinishShader.colorizeTint = glGetUniformLocation(prog, "colorizeTint");
-    blurFinishShader.boostA       = glGetUniformLocation(prog, "boostA");
-
-    prog                               = createProgram(QUADVERTSRC, FRAGBORDER);
-    borderShader.program               = prog;
-    borderShader.proj                  = glGetUniformLocation(prog, "proj");
-    borderShader.thick                 = glGetUniformLocation(prog, "thick");
-    borderShader.posAttrib             = glGetAttribLocation(prog, "pos");
-    borderShader.texAttrib             = glGetAttribLocation(prog, "texcoord");
-    borderShader.topLeft               = glGetUniformLocation(prog, "topLeft");
-    borderShader.bottomRight           = glGetUniformLocation(prog, "bottomRight");
-    borderShader.fullSize              = glGetUniformLocation(prog, "fullSize");
-    borderShader.fullSizeUntransformed = glGetUniformLocation(prog, "fullSizeUntransformed");
-    borderShader.radius                = glGetUniformLocation(prog, "radius");
-    borderShader.radiusOuter           = glGetUniformLocation(prog, "radiusOuter");
-    borderShader.gradient              = glGetUniformLocation(prog, "gradient");
-    borderShader.gradientLength        = glGetUniformLocation(prog, "gradientLength");
-    borderShader.angle                 = glGetUniformLocation(prog, "angle");
-    borderShader.alpha                 = glGetUniformLocation(prog, "alpha");
+    programCache = std::make_unique<CProgramCache>();
+
+    // lets the driver compile on its own threads, ensureProgram then only waits for the one it needs
+    const auto EXTENSIONS = (const char*)glGetString(GL_EXTENSIONS);
+    parallelCompile       = EXTENSIONS && std::string{EXTENSIONS}.contains("GL_KHR_parallel_shader_compile");
+    if (parallelCompile) {
+        const auto MAXTHREADS = (PFNGLMAXSHADERCOMPILERTHREADSKHRPROC)eglGetProcAddress("glMaxShaderCompilerThreadsKHR");
+        if (MAXTHREADS)
+            MAXTHREADS(0xFFFFFFFF);
+    }
+
+    // every draw is this quad, the VAOs of all programs point into it
+    glGenBuffers(1, &quadVBO);
+    glBindBuffer(GL_ARRAY_BUFFER, quadVBO);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(fullVerts), fullVerts, GL_STATIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    // refilled by every instanced draw
+    glGenBuffers(1, &instanceVBO);
+
+    const auto NEEDED = neededPrograms();
+
+    addProgram(rectShader, QUADVERTSRC, QUADFRAGSRC, true, [](CShader& shader) {
+        shader.proj      = glGetUniformLocation(shader.program, "proj");
+        shader.color     = glGetUniformLocation(shader.program, "color");
+        shader.posAttrib = glGetAttribLocation(shader.program, "pos");
+        shader.topLeft   = glGetUniformLocation(shader.program, "topLeft");
+        shader.fullSize  = glGetUniformLocation(shader.program, "fullSize");
+        shader.radius    = glGetUniformLocation(shader.program, "radius");
+    });
+
+    addProgram(texShader, TEXVERTSRC, TEXFRAGSRCRGBA, true, [](CShader& shader) {
+        shader.proj              = glGetUniformLocation(shader.program, "proj");
+        shader.tex               = glGetUniformLocation(shader.program, "tex");
+        shader.alphaMatte        = glGetUniformLocation(shader.program, "texMatte");
+        shader.alpha             = glGetUniformLocation(shader.program, "alpha");
+        shader.texAttrib         = glGetAttribLocation(shader.program, "texcoord");
+        shader.matteTexAttrib    = glGetAttribLocation(shader.program, "texcoordMatte");
+        shader.posAttrib         = glGetAttribLocation(shader.program, "pos");
+        shader.discardOpaque     = glGetUniformLocation(shader.program, "discardOpaque");
+        shader.discardAlpha      = glGetUniformLocation(shader.program, "discardAlpha");
+        shader.discardAlphaValue = glGetUniformLocation(shader.program, "discardAlphaValue");
+        shader.topLeft           = glGetUniformLocation(shader.program, "topLeft");
+        shader.fullSize          = glGetUniformLocation(shader.program, "fullSize");
+        shader.radius            = glGetUniformLocation(shader.program, "radius");
+        shader.applyTint         = glGetUniformLocation(shader.program, "applyTint");
+        shader.tint              = glGetUniformLocation(shader.program, "tint");
+        shader.useAlphaMatte     = glGetUniformLocation(shader.program, "useAlphaMatte");
+    });
+
+    addProgram(blurShader1, TEXVERTSRC, FRAGBLUR1, NEEDED.blur, [](CShader& shader) {
+        shader.tex               = glGetUniformLocation(shader.program, "tex");
+        shader.alpha             = glGetUniformLocation(shader.program, "alpha");
+        shader.proj              = glGetUniformLocation(shader.program, "proj");
+        shader.posAttrib         = glGetAttribLocation(shader.program, "pos");
+        shader.texAttrib         = glGetAttribLocation(shader.program, "texcoord");
+        shader.radius            = glGetUniformLocation(shader.program, "radius");
+        shader.halfpixel         = glGetUniformLocation(shader.program, "halfpixel");
+        shader.passes            = glGetUniformLocation(shader.program, "passes");
+        shader.vibrancy          = glGetUniformLocation(shader.program, "vibrancy");
+        shader.vibrancy_darkness = glGetUniformLocation(shader.program, "vibrancy_darkness");
+    });
+
+    addProgram(blurShader2, TEXVERTSRC, FRAGBLUR2, NEEDED.blur, [](CShader& shader) {
+        shader.tex       = glGetUniformLocation(shader.program, "tex");
+        shader.alpha     = glGetUniformLocation(shader.program, "alpha");
+        shader.proj      = glGetUniformLocation(shader.program, "proj");
+        shader.posAttrib = glGetAttribLocation(shader.program, "pos");
+        shader.texAttrib = glGetAttribLocation(shader.program, "texcoord");
+        shader.radius    = glGetUniformLocation(shader.program, "radius");
+        shader.halfpixel = glGetUniformLocation(shader.program, "halfpixel");
+    });
+
+    addProgram(blurPrepareShader, TEXVERTSRC, FRAGBLURPREPARE, NEEDED.blur, [](CShader& shader) {
+        shader.tex        = glGetUniformLocation(shader.program, "tex");
+        shader.proj       = glGetUniformLocation(shader.program, "proj");
+        shader.posAttrib  = glGetAttribLocation(shader.program, "pos");
+        shader.texAttrib  = glGetAttribLocation(shader.program, "texcoord");
+        shader.contrast   = glGetUniformLocation(shader.program, "contrast");
+        shader.brightness = glGetUniformLocation(shader.program, "brightness");
+    });
+
+    addProgram(blurFinishShader, TEXVERTSRC, FRAGBLURFINISH, NEEDED.blur, [](CShader& shader) {
+        shader.tex          = glGetUniformLocation(shader.program, "tex");
+        shader.proj         = glGetUniformLocation(shader.program, "proj");
+        shader.posAttrib    = glGetAttribLocation(shader.program, "pos");
+        shader.texAttrib    = glGetAttribLocation(shader.program, "texcoord");
+        shader.brightness   = glGetUniformLocation(shader.program, "brightness");
+        shader.noise        = glGetUniformLocation(shader.program, "noise");
+        shader.colorize     = glGetUniformLocation(shader.program, "colorize");
+        shader.colorizeTint = glGetUniformLocation(shader.program, "colorizeTint");
+        shader.boostA       = glGetUniformLocation(shader.program, "boostA");
+    });
+
+    addProgram(borderShader, QUADVERTSRC, FRAGBORDER, NEEDED.border, [](CShader& shader) {
+        shader.proj                  = glGetUniformLocation(shader.program, "proj");
+        shader.thick                 = glGetUniformLocation(shader.program, "thick");
+        shader.posAttrib             = glGetAttribLocation(shader.program, "pos");
+        shader.texAttrib             = glGetAttribLocation(shader.program, "texcoord");
+        shader.topLeft               = glGetUniformLocation(shader.program, "topLeft");
+        shader.bottomRight           = glGetUniformLocation(shader.program, "bottomRight");
+        shader.fullSize              = glGetUniformLocation(shader.program, "fullSize");
+        shader.fullSizeUntransformed = glGetUniformLocation(shader.program, "fullSizeUntransformed");
+        shader.radius                = glGetUniformLocation(shader.program, "radius");
+        shader.radiusOuter           = glGetUniformLocation(shader.program, "radiusOuter");
+        shader.gradient              = glGetUniformLocation(shader.program, "gradient");
+        shader.gradientLength        = glGetUniformLocation(shader.program, "gradientLength");
+        shader.angle                 = glGetUniformLocation(shader.program, "angle");
+        shader.alpha                 = glGetUniformLocation(shader.program, "alpha");
+    });
+
+    addProgram(instancedRectShader, INSTANCEDVERTSRC, INSTANCEDQUADFRAGSRC, NEEDED.dotRects, [](CShader& shader) {
+        shader.color = glGetUniformLocation(shader.program, "color");
+        getInstancedLocations(shader);
+    });
+
+    addProgram(instancedTexShader, INSTANCEDVERTSRC, INSTANCEDTEXFRAGSRC, NEEDED.dotTextures, [](CShader& shader) {
+        shader.tex = glGetUniformLocation(shader.program, "tex");
+        getInstancedLocations(shader);
+    });
+
+    // the loading bar and every texture, the others finish when first used
+    ensureProgram(rectShader);
+    ensureProgram(texShader);
 
     asyncResourceGatherer = std::make_unique<CAsyncResourceGatherer>();
 }
 
-static int  frames         = 0;
-static bool firstFullFrame = false;
+void CRenderer::addProgram(CShader& shader, const std::string& vert, const std::string& frag, bool needed, std::function<void(CShader&)> getLocations) {
+    auto& pending        = pendingPrograms.emplace_back();
+    pending.shader       = &shader;
+    pending.vert         = vert;
+    pending.frag         = frag;
+    pending.needed       = needed;
+    pending.getLocations = getLocations;
+
+    // without the extension a compile blocks, so only what is certainly drawn starts now
+    if (needed && parallelCompile)
+        startProgram(pending);
+}
+
+void CRenderer::startProgram(SPendingProgram& pending) {
+    pending.started = true;
+
+    if (const auto CACHED = programCache->load(pending.vert, pending.frag); CACHED) {
+        pending.shader->program = CACHED;
+        return;
+    }
+
+    pending.vertShader = compileShader(GL_VERTEX_SHADER, pending.vert);
+    pending.fragShader = compileShader(GL_FRAGMENT_SHADER, pending.frag);
+
+    auto prog = glCreateProgram();
+    glAttachShader(prog, pending.vertShader);
+    glAttachShader(prog, pending.fragShader);
+    glProgramParameteri(prog, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    glLinkProgram(prog);
+
+    pending.shader->program = prog;
+}
+
+void CRenderer::finishProgram(SPendingProgram& pending) {
+    if (!pending.started)
+        startProgram(pending);
+
+    const auto PROG = pending.shader->program;
+
+    // not cached, the status queries below wait for the compile
+    if (pending.vertShader) {
+        GLint ok;
+        glGetShaderiv(pending.vertShader, GL_COMPILE_STATUS, &ok);
+        RASSERT(ok != GL_FALSE, "Compiling shader failed. VERTEX NOT OK! Shader source:\n\n{}", pending.vert);
+        glGetShaderiv(pending.fragShader, GL_COMPILE_STATUS, &ok);
+        RASSERT(ok != GL_FALSE, "Compiling shader failed. FRAGMENT NOT OK! Shader source:\n\n{}", pending.frag);
+
+        glDetachShader(PROG, pending.vertShader);
+        glDetachShader(PROG, pending.fragShader);
+        glDeleteShader(pending.vertShader);
+        glDeleteShader(pending.fragShader);
+
+        glGetProgramiv(PROG, GL_LINK_STATUS, &ok);
+        RASSERT(ok != GL_FALSE, "createProgram() failed! GL_LINK_STATUS not OK!");
+
+        programCache->store(PROG, pending.vert, pending.frag);
+    }
+
+    pending.getLocations(*pending.shader);
+
+    // pos and texcoord are both the unit quad
+    glGenVertexArrays(1, &pending.shader->vao);
+    glBindVertexArray(pending.shader->vao);
+    glBindBuffer(GL_ARRAY_BUFFER, quadVBO);
+
+    for (const auto ATTRIB : {pending.shader->posAttrib, pending.shader->texAttrib}) {
+        if (ATTRIB < 0)
+            continue;
+
+        glVertexAttribPointer(ATTRIB, 2, GL_FLOAT, GL_FALSE, 0, nullptr);
+        glEnableVertexAttribArray(ATTRIB);
+    }
+
+    // one SInstanceData per quad, see drawInstances
+    if (pending.shader->instanceAlphaAttrib >= 0) {
+        glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+
+        const auto INSTANCEATTRIB = [](GLint attrib, GLint size, size_t offset) {
+            if (attrib < 0)
+                return;
+
+            glVertexAttribPointer(attrib, size, GL_FLOAT, GL_FALSE, sizeof(SInstanceData), (const void*)offset);
+            glVertexAttribDivisor(attrib, 1);
+            glEnableVertexAttribArray(attrib);
+        };
+
+        for (size_t row = 0; row < 3; ++row) {
+            INSTANCEATTRIB(pending.shader->instanceRowAttribs[row], 3, offsetof(SInstanceData, matrix) + row * 3 * sizeof(float));
+        }
+        INSTANCEATTRIB(pending.shader->instanceTopLeftAttrib, 2, offsetof(SInstanceData, topLeft));
+        INSTANCEATTRIB(pending.shader->instanceAlphaAttrib, 1, offsetof(SInstanceData, alpha));
+    }
+
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glState.invalidateProgram();
+}
+
+void CRenderer::ensureProgram(CShader& shader) {
+    if (pendingPrograms.empty())
+        return;
+
+    const auto IT = std::ranges::find_if(pendingPrograms, [&shader](const auto& p) { return p.shader == &shader; });
+    if (IT == pendingPrograms.end())
+        return;
+
+    // a widget needs one neededPrograms didn't expect, still works, just with a stall
+    if (!IT->needed)
+        Debug::log(LOG, "[shaders] Compiling a program on first use");
+
+    finishProgram(*IT);
+    pendingPrograms.erase(IT);
+}
+
+void CRenderer::useProgram(CShader& shader) {
+    ensureProgram(shader);
+    glState.useProgram(shader.program, shader.vao);
+}
+
+void CRenderer::finishIdlePrograms() {
+    for (auto it = pendingPrograms.begin(); it != pendingPrograms.end();) {
+        if (!it->needed) {
+            ++it;
+            continue;
+        }
+
+        if (parallelCompile) {
+            GLint done = GL_FALSE;
+            glGetProgramiv(it->shader->program, GL_COMPLETION_STATUS_KHR, &done);
+            if (done == GL_FALSE) {
+                ++it;
+                continue;
+            }
+        }
+
+        finishProgram(*it);
+        it = pendingPrograms.erase(it);
+
+        // this one blocked, leave the rest for the next frame
+        if (!parallelCompile)
+            return;
+    }
+}
+
+CRenderer::~CRenderer() {
+    glDeleteBuffers(1, &quadVBO);
+    glDeleteBuffers(1, &instanceVBO);
+}
+
+static int frames = 0;
 
 //
 CRenderer::SRenderFeedback CRenderer::renderLock(const CSessionLockSurface& surf) {
@@ -183,21 +382,28 @@ CRenderer::SRenderFeedback CRenderer::renderLock(const CSessionLockSurface& surf
     g_pEGL->makeCurrent(surf.eglSurface);
     glViewport(0, 0, surf.size.x, surf.size.y);
 
+    // how many frames old the back buffer is, 0 if unknown. Has to be queried before drawing to it
+    EGLint bufferAge = 0;
+    if (g_pEGL->bufferAge && !eglQuerySurface(g_pEGL->eglDisplay, surf.eglSurface, EGL_BUFFER_AGE_EXT, &bufferAge))
+        bufferAge = 0;
+
     GLint fb = 0;
     glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &fb);
     pushFb(fb);
 
-    glClearColor(0.0, 0.0, 0.0, 0.0);
-    glClear(GL_COLOR_BUFFER_BIT);
-
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+    glState.setCapability(GL_BLEND, true);
+    glState.blendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
 
     SRenderFeedback feedback;
     float           bga           = 0.0;
     const bool      WAITFORASSETS = !g_pHyprlock->m_bImmediateRender && !asyncResourceGatherer->gathered;
 
     if (WAITFORASSETS) {
+        // nothing else to do until the assets are there
+        finishIdlePrograms();
+
+        glClearColor(0.0, 0.0, 0.0, 0.0);
+        glClear(GL_COLOR_BUFFER_BIT);
 
         // render status
         if (!**PDISABLEBAR) {
@@ -207,144 +413,559 @@ CRenderer::SRenderFeedback CRenderer::renderLock(const CSessionLockSurface& surf
     } else {
 
         if (!firstFullFrame) {
-            firstFullFrameTime = std::chrono::system_clock::now();
-            firstFullFrame     = true;
-        }
-
-        bga = std::clamp(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now() - firstFullFrameTime).count() / 500000.0, 0.0, 1.0);
+            firstFullFrame = true;
 
-        if (g_pHyprlock->m_bNoFadeIn)
-            bga = 1.0;
+            if (g_pHyprlock->m_bNoFadeIn)
+                opacity.warp(1.0);
+            else
+                opacity.animateTo(1.0);
+        }
 
         if (g_pHyprlock->m_bFadeStarted && !**PNOFADEOUT) {
-            bga =
-                std::clamp(std::chrono::duration_cast<std::chrono::microseconds>(g_pHyprlock->m_tFadeEnds - std::chrono::system_clock::now()).count() / 500000.0 - 0.02, 0.0, 1.0);
-            // - 0.02 so that the fade ends a little earlier than the final second
+            // 490ms, so that the fade ends a little earlier than the lock gets released
+            opacity.setDuration(std::chrono::milliseconds(490));
+            opacity.animateTo(0.0);
         }
+
+        bga = opacity.value();
         // render widgets
-        const auto WIDGETS = getOrCreateWidgetsFor(&surf);
+        const auto WIDGETS  = getOrCreateWidgetsFor(&surf);
+        auto&      list     = drawLists[&surf];
+        bool       isStatic = true;
+        list.staticCommands = 0;
+        recordingFor        = &surf;
         for (auto& w : *WIDGETS) {
-            feedback.needsFrame = w->draw({bga}) || feedback.needsFrame;
+            const bool NEEDSFRAME = w->draw({bga});
+            feedback.needsFrame   = NEEDSFRAME || feedback.needsFrame;
+
+            isStatic = isStatic && !NEEDSFRAME && w->isStatic();
+            if (isStatic)
+                list.staticCommands = list.commands.size();
         }
+        recordingFor = nullptr;
+
+        flushDrawList(&surf, bufferAge, feedback);
     }
 
     frames++;
 
     Debug::log(TRACE, "frame {}", frames);
 
-    feedback.needsFrame = feedback.needsFrame || !asyncResourceGatherer->gathered || bga < 1.0;
+    // keep going until every animation settled
+    feedback.needsFrame = feedback.needsFrame || !asyncResourceGatherer->gathered || g_pAnimationManager->animating();
 
-    glDisable(GL_BLEND);
+    glState.setCapability(GL_BLEND, false);
 
     return feedback;
 }
 
 void CRenderer::renderRect(const CBox& box, const CColor& col, int rounding) {
-    const auto ROUNDEDBOX = box.copy().round();
-    Mat3x3     matrix     = projMatrix.projectBox(ROUNDEDBOX, HYPRUTILS_TRANSFORM_NORMAL, box.rot);
-    Mat3x3     glMatrix   = projection.copy().multiply(matrix);
+    SDrawCommand cmd;
+    cmd.type     = SDrawCommand::DRAW_RECT;
+    cmd.box      = box;
+    cmd.color    = col;
+    cmd.rounding = rounding;
+    submit(std::move(cmd));
+}
+
+void CRenderer::renderBorder(const CBox& box, const CGradientValueData& gradient, int thickness, int rounding, float alpha) {
+    SDrawCommand cmd;
+    cmd.type          = SDrawCommand::DRAW_BORDER;
+    cmd.box           = box;
+    cmd.rounding      = rounding;
+    cmd.gradient      = gradient.m_vColors;
+    cmd.gradientAngle = gradient.m_fAngle;
+    cmd.thickness     = thickness;
+    cmd.alpha         = alpha;
+    submit(std::move(cmd));
+}
 
-    glUseProgram(rectShader.program);
+void CRenderer::renderTexture(const CBox& box, const CTexture& tex, float a, int rounding, std::optional<eTransform> tr) {
+    SDrawCommand cmd;
+    cmd.type      = SDrawCommand::DRAW_TEXTURE;
+    cmd.box       = box;
+    cmd.rounding  = rounding;
+    cmd.alpha     = a;
+    cmd.texTarget = tex.m_iTarget;
+    cmd.texID     = tex.m_iTexID;
+    cmd.transform = tr;
+    submit(std::move(cmd));
+}
+
+// the smallest box containing both, empty boxes are ignored
+static CBox boxUnion(const CBox& a, const CBox& b) {
+    if (a.empty())
+        return b;
+    if (b.empty())
+        return a;
+
+    const auto X2 = std::max(a.x + a.w, b.x + b.w);
+    const auto Y2 = std::max(a.y + a.h, b.y + b.h);
+    const auto X  = std::min(a.x, b.x);
+    const auto Y  = std::min(a.y, b.y);
+    return {X, Y, X2 - X, Y2 - Y};
+}
+
+// the box of a command is what all instances cover together
+static CBox instancesBounds(const std::vector<CRenderer::SQuadInstance>& instances) {
+    CBox bounds = instances.front().box;
+    for (const auto& inst : instances) {
+        bounds = boxUnion(bounds, inst.box);
+    }
+
+    return bounds;
+}
 
-    glUniformMatrix3fv(rectShader.proj, 1, GL_TRUE, glMatrix.getMatrix().data());
+void CRenderer::renderRectInstances(const std::vector<SQuadInstance>& instances, const CColor& col, int rounding) {
+    if (instances.empty())
+        return;
+
+    SDrawCommand cmd;
+    cmd.type      = SDrawCommand::DRAW_RECT;
+    cmd.box       = instancesBounds(instances);
+    cmd.color     = col;
+    cmd.rounding  = rounding;
+    cmd.instances = instances;
+    submit(std::move(cmd));
+}
+
+void CRenderer::renderTextureInstances(const std::vector<SQuadInstance>& instances, const CTexture& tex, int rounding) {
+    if (instances.empty())
+        return;
+
+    SDrawCommand cmd;
+    cmd.type      = SDrawCommand::DRAW_TEXTURE;
+    cmd.box       = instancesBounds(instances);
+    cmd.rounding  = rounding;
+    cmd.texTarget = tex.m_iTarget;
+    cmd.texID     = tex.m_iTexID;
+    cmd.instances = instances;
+    submit(std::move(cmd));
+}
+
+void CRenderer::clearBox(const CBox& box) {
+    SDrawCommand cmd;
+    cmd.type = SDrawCommand::DRAW_CLEAR;
+    cmd.box  = box;
+    submit(std::move(cmd));
+}
+
+void CRenderer::submit(SDrawCommand&& cmd) {
+    if (!captures.empty() && captures.back().first == boundFBs.size()) {
+        cmd.scissor = glState.scissorBox();
+        captures.back().second.emplace_back(std::move(cmd));
+        return;
+    }
+
+    // only what goes onto the lock surface itself, framebuffers of widgets are drawn right away
+    if (!recordingFor || boundFBs.size() != 1) {
+        draw(cmd);
+        return;
+    }
+
+    cmd.scissor = glState.scissorBox();
+    drawLists[recordingFor].commands.emplace_back(std::move(cmd));
+}
+
+void CRenderer::draw(const SDrawCommand& cmd) {
+    if (!cmd.instances.empty()) {
+        drawInstances(cmd);
+        return;
+    }
+
+    switch (cmd.type) {
+        case SDrawCommand::DRAW_RECT: drawRect(cmd); break;
+        case SDrawCommand::DRAW_BORDER: drawBorder(cmd); break;
+        case SDrawCommand::DRAW_TEXTURE: drawTexture(cmd); break;
+        case SDrawCommand::DRAW_CLEAR: drawClear(cmd); break;
+    }
+}
+
+void CRenderer::drawRect(const SDrawCommand& cmd) {
+    const auto& box        = cmd.box;
+    const auto& col        = cmd.color;
+    const auto  ROUNDEDBOX = box.copy().round();
+    Mat3x3      matrix     = projMatrix.projectBox(ROUNDEDBOX, HYPRUTILS_TRANSFORM_NORMAL, box.rot);
+    Mat3x3      glMatrix   = projection.copy().multiply(matrix);
+
+    useProgram(rectShader);
+
+    glState.uniformMatrix3fv(rectShader.proj, glMatrix.getMatrix().data());
 
     // premultiply the color as well as we don't work with straight alpha
-    glUniform4f(rectShader.color, col.r * col.a, col.g * col.a, col.b * col.a, col.a);
+    glState.uniform4f(rectShader.color, col.r * col.a, col.g * col.a, col.b * col.a, col.a);
 
     const auto TOPLEFT  = Vector2D(ROUNDEDBOX.x, ROUNDEDBOX.y);
     const auto FULLSIZE = Vector2D(ROUNDEDBOX.width, ROUNDEDBOX.height);
 
     // Rounded corners
-    glUniform2f(rectShader.topLeft, (float)TOPLEFT.x, (float)TOPLEFT.y);
-    glUniform2f(rectShader.fullSize, (float)FULLSIZE.x, (float)FULLSIZE.y);
-    glUniform1f(rectShader.radius, rounding);
-
-    glVertexAttribPointer(rectShader.posAttrib, 2, GL_FLOAT, GL_FALSE, 0, fullVerts);
-
-    glEnableVertexAttribArray(rectShader.posAttrib);
+    glState.uniform2f(rectShader.topLeft, (float)TOPLEFT.x, (float)TOPLEFT.y);
+    glState.uniform2f(rectShader.fullSize, (float)FULLSIZE.x, (float)FULLSIZE.y);
+    glState.uniform1f(rectShader.radius, cmd.rounding);
 
     glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
-
-    glDisableVertexAttribArray(rectShader.posAttrib);
 }
 
-void CRenderer::renderBorder(const CBox& box, const CGradientValueData& gradient, int thickness, int rounding, float alpha) {
-    const auto ROUNDEDBOX = box.copy().round();
-    Mat3x3     matrix     = projMatrix.projectBox(ROUNDEDBOX, HYPRUTILS_TRANSFORM_NORMAL, box.rot);
-    Mat3x3     glMatrix   = projection.copy().multiply(matrix);
+void CRenderer::drawBorder(const SDrawCommand& cmd) {
+    const auto& box        = cmd.box;
+    const auto  ROUNDEDBOX = box.copy().round();
+    Mat3x3      matrix     = projMatrix.projectBox(ROUNDEDBOX, HYPRUTILS_TRANSFORM_NORMAL, box.rot);
+    Mat3x3      glMatrix   = projection.copy().multiply(matrix);
 
-    glUseProgram(borderShader.program);
+    useProgram(borderShader);
 
-    glUniformMatrix3fv(borderShader.proj, 1, GL_TRUE, glMatrix.getMatrix().data());
+    glState.uniformMatrix3fv(borderShader.proj, glMatrix.getMatrix().data());
 
     static_assert(sizeof(CColor) == 4 * sizeof(float)); // otherwise the line below this will fail
 
-    glUniform4fv(borderShader.gradient, gradient.m_vColors.size(), (float*)gradient.m_vColors.data());
-    glUniform1i(borderShader.gradientLength, gradient.m_vColors.size());
-    glUniform1f(borderShader.angle, (int)(gradient.m_fAngle / (M_PI / 180.0)) % 360 * (M_PI / 180.0));
-    glUniform1f(borderShader.alpha, alpha);
+    glState.uniform4fv(borderShader.gradient, cmd.gradient.size(), (float*)cmd.gradient.data());
+    glState.uniform1i(borderShader.gradientLength, (int)cmd.gradient.size());
+    glState.uniform1f(borderShader.angle, (int)(cmd.gradientAngle / (M_PI / 180.0)) % 360 * (M_PI / 180.0));
+    glState.uniform1f(borderShader.alpha, cmd.alpha);
 
     const auto TOPLEFT  = Vector2D(ROUNDEDBOX.x, ROUNDEDBOX.y);
     const auto FULLSIZE = Vector2D(ROUNDEDBOX.width, ROUNDEDBOX.height);
 
-    glUniform2f(borderShader.topLeft, (float)TOPLEFT.x, (float)TOPLEFT.y);
-    glUniform2f(borderShader.fullSize, (float)FULLSIZE.x, (float)FULLSIZE.y);
-    glUniform2f(borderShader.fullSizeUntransformed, (float)box.width, (float)box.height);
-    glUniform1f(borderShader.radius, rounding);
-    glUniform1f(borderShader.radiusOuter, rounding);
-    glUniform1f(borderShader.thick, thickness);
-
-    glVertexAttribPointer(borderShader.posAttrib, 2, GL_FLOAT, GL_FALSE, 0, fullVerts);
-    glVertexAttribPointer(borderShader.texAttrib, 2, GL_FLOAT, GL_FALSE, 0, fullVerts);
-
-    glEnableVertexAttribArray(borderShader.posAttrib);
-    glEnableVertexAttribArray(borderShader.texAttrib);
+    glState.uniform2f(borderShader.topLeft, (float)TOPLEFT.x, (float)TOPLEFT.y);
+    glState.uniform2f(borderShader.fullSize, (float)FULLSIZE.x, (float)FULLSIZE.y);
+    glState.uniform2f(borderShader.fullSizeUntransformed, (float)box.width, (float)box.height);
+    glState.uniform1f(borderShader.radius, cmd.rounding);
+    glState.uniform1f(borderShader.radiusOuter, cmd.rounding);
+    glState.uniform1f(borderShader.thick, cmd.thickness);
 
     glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
-
-    glDisableVertexAttribArray(borderShader.posAttrib);
-    glDisableVertexAttribArray(borderShader.texAttrib);
 }
 
-void CRenderer::renderTexture(const CBox& box, const CTexture& tex, float a, int rounding, std::optional<eTransform> tr) {
-    const auto ROUNDEDBOX = box.copy().round();
-    Mat3x3     matrix     = projMatrix.projectBox(ROUNDEDBOX, tr.value_or(HYPRUTILS_TRANSFORM_FLIPPED_180), box.rot);
-    Mat3x3     glMatrix   = projection.copy().multiply(matrix);
+void CRenderer::drawTexture(const SDrawCommand& cmd) {
+    const auto& box        = cmd.box;
+    const auto  ROUNDEDBOX = box.copy().round();
+    Mat3x3      matrix     = projMatrix.projectBox(ROUNDEDBOX, cmd.transform.value_or(HYPRUTILS_TRANSFORM_FLIPPED_180), box.rot);
+    Mat3x3      glMatrix   = projection.copy().multiply(matrix);
 
-    CShader*   shader = &texShader;
+    CShader*    shader = &texShader;
 
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(tex.m_iTarget, tex.m_iTexID);
+    glState.bindTexture(cmd.texTarget, cmd.texID);
 
-    glUseProgram(shader->program);
+    useProgram(*shader);
 
-    glUniformMatrix3fv(shader->proj, 1, GL_TRUE, glMatrix.getMatrix().data());
-    glUniform1i(shader->tex, 0);
-    glUniform1f(shader->alpha, a);
+    glState.uniformMatrix3fv(shader->proj, glMatrix.getMatrix().data());
+    glState.uniform1i(shader->tex, 0);
+    glState.uniform1f(shader->alpha, cmd.alpha);
     const auto TOPLEFT  = Vector2D(ROUNDEDBOX.x, ROUNDEDBOX.y);
     const auto FULLSIZE = Vector2D(ROUNDEDBOX.width, ROUNDEDBOX.height);
 
     // Rounded corners
-    glUniform2f(shader->topLeft, TOPLEFT.x, TOPLEFT.y);
-    glUniform2f(shader->fullSize, FULLSIZE.x, FULLSIZE.y);
-    glUniform1f(shader->radius, rounding);
+    glState.uniform2f(shader->topLeft, TOPLEFT.x, TOPLEFT.y);
+    glState.uniform2f(shader->fullSize, FULLSIZE.x, FULLSIZE.y);
+    glState.uniform1f(shader->radius, cmd.rounding);
 
-    glUniform1i(shader->discardOpaque, 0);
-    glUniform1i(shader->discardAlpha, 0);
-    glUniform1i(shader->applyTint, 0);
+    glState.uniform1i(shader->discardOpaque, 0);
+    glState.uniform1i(shader->discardAlpha, 0);
+    glState.uniform1i(shader->applyTint, 0);
 
-    glVertexAttribPointer(shader->posAttrib, 2, GL_FLOAT, GL_FALSE, 0, fullVerts);
-    glVertexAttribPointer(shader->texAttrib, 2, GL_FLOAT, GL_FALSE, 0, fullVerts);
+    glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+}
 
-    glEnableVertexAttribArray(shader->posAttrib);
-    glEnableVertexAttribArray(shader->texAttrib);
+void CRenderer::drawInstances(const SDrawCommand& cmd) {
+    const bool TEXTURED = cmd.type == SDrawCommand::DRAW_TEXTURE;
+    CShader&   shader   = TEXTURED ? instancedTexShader : instancedRectShader;
+
+    // the same matrices the single quad draws would use, only computed here instead of uploaded one by one
+    instanceData.clear();
+    for (const auto& inst : cmd.instances) {
+        const auto ROUNDEDBOX = inst.box.copy().round();
+        Mat3x3     matrix     = projMatrix.projectBox(ROUNDEDBOX, TEXTURED ? cmd.transform.value_or(HYPRUTILS_TRANSFORM_FLIPPED_180) : HYPRUTILS_TRANSFORM_NORMAL, inst.box.rot);
+        Mat3x3     glMatrix   = projection.copy().multiply(matrix);
+        const auto MATRIX     = glMatrix.getMatrix();
+
+        auto&      data = instanceData.emplace_back();
+        std::copy(MATRIX.begin(), MATRIX.end(), data.matrix);
+        data.topLeft[0] = ROUNDEDBOX.x;
+        data.topLeft[1] = ROUNDEDBOX.y;
+        data.alpha      = inst.alpha;
+    }
 
-    glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+    if (TEXTURED)
+        glState.bindTexture(cmd.texTarget, cmd.texID);
+
+    useProgram(shader);
+
+    glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+    glBufferData(GL_ARRAY_BUFFER, instanceData.size() * sizeof(SInstanceData), instanceData.data(), GL_STREAM_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    // all instances have the same size
+    const auto FULLSIZE = cmd.instances.front().box.copy().round().size();
+    glState.uniform2f(shader.fullSize, FULLSIZE.x, FULLSIZE.y);
+    glState.uniform1f(shader.radius, cmd.rounding);
+
+    if (TEXTURED)
+        glState.uniform1i(shader.tex, 0);
+    else // premultiplied, the instance alpha scales all of it
+        glState.uniform4f(shader.color, cmd.color.r * cmd.color.a, cmd.color.g * cmd.color.a, cmd.color.b * cmd.color.a, cmd.color.a);
+
+    glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, instanceData.size());
+}
+
+void CRenderer::drawClear(const SDrawCommand& cmd) {
+    applyScissor(cmd.box);
+    glClearColor(0.0, 0.0, 0.0, 0.0);
+    glClear(GL_COLOR_BUFFER_BIT);
+    applyScissor(std::nullopt);
+}
+
+void CRenderer::applyScissor(std::optional<CBox> box) {
+    if (repaintBox)
+        box = box ? box->intersection(*repaintBox) : *repaintBox;
+
+    if (!box) {
+        glState.setCapability(GL_SCISSOR_TEST, false);
+        return;
+    }
+
+    glState.setCapability(GL_SCISSOR_TEST, true);
+    glState.scissor(box->x, box->y, box->width, box->height);
+}
+
+// what a command may cover, rotated boxes by the circle around them
+static CBox commandBounds(const CRenderer::SDrawCommand& cmd) {
+    CBox bounds = cmd.box;
+    if (cmd.type == CRenderer::SDrawCommand::DRAW_BORDER)
+        bounds.expand(cmd.thickness);
+
+    if (bounds.rot != 0) {
+        const auto CENTER = bounds.middle();
+        const auto RADIUS = std::sqrt(bounds.w * bounds.w + bounds.h * bounds.h) / 2.0;
+        bounds            = {CENTER.x - RADIUS, CENTER.y - RADIUS, RADIUS * 2, RADIUS * 2};
+    }
+
+    return bounds;
+}
+
+static std::optional<CBox> commandScissor(const CRenderer::SDrawCommand& cmd) {
+    if (!cmd.scissor)
+        return std::nullopt;
+
+    return CBox{(double)cmd.scissor->at(0), (double)cmd.scissor->at(1), (double)cmd.scissor->at(2), (double)cmd.scissor->at(3)};
+}
+
+// whole pixels a command may change, with room for antialiased edges
+static CBox damageBounds(const CRenderer::SDrawCommand& cmd) {
+    CBox bounds = commandBounds(cmd).expand(2);
+    if (cmd.scissor)
+        bounds = bounds.intersection(*commandScissor(cmd));
+
+    const auto X = std::floor(bounds.x);
+    const auto Y = std::floor(bounds.y);
+    return {X, Y, std::ceil(bounds.x + bounds.w) - X, std::ceil(bounds.y + bounds.h) - Y};
+}
+
+bool CRenderer::SDrawCommand::sameBatch(const SDrawCommand& other) const {
+    // a clear is never batched
+    return type == other.type && type != DRAW_CLEAR && instances.empty() == other.instances.empty() && texTarget == other.texTarget && texID == other.texID;
+}
+
+bool CRenderer::SDrawCommand::sameLayout(const SDrawCommand& other) const {
+    return type == other.type && instances.empty() == other.instances.empty() && texTarget == other.texTarget && texID == other.texID && box == other.box && box.rot == other.box.rot && thickness == other.thickness && scissor == other.scissor;
+}
+
+bool CRenderer::SDrawCommand::sameContent(const SDrawCommand& other) const {
+    return sameLayout(other) && rounding == other.rounding && alpha == other.alpha && color == other.color && gradient == other.gradient &&
+        gradientAngle == other.gradientAngle && transform == other.transform &&
+        std::ranges::equal(instances, other.instances, [](const auto& a, const auto& b) { return a.box == b.box && a.box.rot == b.box.rot && a.alpha == b.alpha; });
+}
+
+void CRenderer::useStaticLayer(SDrawList& list, const Vector2D& size) {
+    std::vector<SDrawCommand> statics(list.commands.begin(), list.commands.begin() + list.staticCommands);
+
+    // a single command gains nothing from a layer
+    if (statics.size() < 2) {
+        if (list.layerFB.isAllocated())
+            list.layerFB.release();
+
+        list.layerCommands.clear();
+        list.lastStaticCommands.clear();
+        return;
+    }
+
+    const auto SAME = [](const std::vector<SDrawCommand>& a, const std::vector<SDrawCommand>& b) {
+        return a.size() == b.size() && std::ranges::equal(a, b, [](const auto& x, const auto& y) { return x.sameContent(y); });
+    };
+
+    // a texture of theirs changed, e.g. a new screenshot or image
+    const bool TEXTURECHANGED = std::ranges::any_of(statics, [&](const auto& cmd) { return cmd.type == SDrawCommand::DRAW_TEXTURE && list.damagedTextures.contains(cmd.texID); });
+    bool       valid          = !TEXTURECHANGED && list.layerFB.isAllocated() && SAME(statics, list.layerCommands);
+
+    // only redrawn once they are the same as last frame, so fading in or out doesn't redraw it every frame
+    if (!valid && !TEXTURECHANGED && SAME(statics, list.lastStaticCommands)) {
+        list.layerFB.alloc(size.x, size.y, true);
+        pushFb(list.layerFB);
+
+        applyScissor(std::nullopt);
+        glClearColor(0.0, 0.0, 0.0, 0.0);
+        glClear(GL_COLOR_BUFFER_BIT);
+
+        glState.setCapability(GL_BLEND, true);
+        for (const auto& CMD : statics) {
+            applyScissor(commandScissor(CMD));
+            draw(CMD);
+        }
+        glState.setCapability(GL_SCISSOR_TEST, false);
+
+        popFb();
+
+        list.layerCommands = statics;
+        valid              = true;
+    }
 
-    glDisableVertexAttribArray(shader->posAttrib);
-    glDisableVertexAttribArray(shader->texAttrib);
+    list.lastStaticCommands = std::move(statics);
 
-    glBindTexture(tex.m_iTarget, 0);
+    if (!valid)
+        return;
+
+    // they are at the bottom, so drawing the layer onto the cleared surface gives the same as drawing them one by one
+    SDrawCommand layer;
+    layer.type      = SDrawCommand::DRAW_TEXTURE;
+    layer.box       = {{}, size};
+    layer.texTarget = list.layerFB.m_cTex.m_iTarget;
+    layer.texID     = list.layerFB.m_cTex.m_iTexID;
+    layer.transform = HYPRUTILS_TRANSFORM_NORMAL;
+
+    list.commands.erase(list.commands.begin(), list.commands.begin() + list.staticCommands);
+    list.commands.insert(list.commands.begin(), std::move(layer));
+}
+
+std::vector<CBox> CRenderer::frameDamage(SDrawList& list, const CBox& surfaceBox) {
+    std::vector<CBox> damage;
+    const auto        ADD = [&](const SDrawCommand& cmd) {
+        const auto BOX = damageBounds(cmd).intersection(surfaceBox);
+        if (!BOX.empty())
+            damage.emplace_back(BOX);
+    };
+
+    // commands are matched regardless of their position in the list, widgets keep their z order.
+    // Whatever has no exact match appeared, went away or changed, both where it was and where it is now.
+    std::vector<bool> matched(list.lastCommands.size(), false);
+    for (const auto& CMD : list.commands) {
+        bool found = false;
+        if (CMD.type != SDrawCommand::DRAW_TEXTURE || !list.damagedTextures.contains(CMD.texID)) {
+            for (size_t i = 0; i < list.lastCommands.size(); ++i) {
+                if (matched[i] || !CMD.sameContent(list.lastCommands[i]))
+                    continue;
+
+                matched[i] = true;
+                found      = true;
+                break;
+            }
+        }
+
+        if (!found)
+            ADD(CMD);
+    }
+
+    for (size_t i = 0; i < list.lastCommands.size(); ++i) {
+        if (!matched[i])
+            ADD(list.lastCommands[i]);
+    }
+
+    return damage;
+}
+
+void CRenderer::flushDrawList(const CSessionLockSurface* surf, int bufferAge, SRenderFeedback& feedback) {
+    // with triple buffering a buffer is at most 3 frames old, anything older is drawn entirely
+    constexpr size_t MAXBUFFERAGE = 4;
+
+    auto&            list       = drawLists[surf];
+    const CBox       SURFACEBOX = {{}, surf->size};
+
+    useStaticLayer(list, surf->size);
+
+    feedback.fullDamage = list.fullDamage;
+    if (!list.fullDamage)
+        feedback.damage = frameDamage(list, SURFACEBOX);
+
+    list.fullDamage = false;
+    list.damagedTextures.clear();
+
+    if (feedback.fullDamage)
+        list.damageHistory.emplace_back(std::nullopt);
+    else {
+        CBox bounds;
+        for (const auto& box : feedback.damage) {
+            bounds = boxUnion(bounds, box);
+        }
+        list.damageHistory.emplace_back(bounds);
+    }
+
+    if (list.damageHistory.size() > MAXBUFFERAGE)
+        list.damageHistory.erase(list.damageHistory.begin());
+
+    // the back buffer still shows the frame from bufferAge frames ago, everything damaged since then is drawn again
+    repaintBox.reset();
+    if (bufferAge > 0 && (size_t)bufferAge <= list.damageHistory.size()) {
+        repaintBox = CBox{};
+        for (auto it = list.damageHistory.end() - bufferAge; it != list.damageHistory.end(); ++it) {
+            if (!*it) {
+                repaintBox.reset();
+                break;
+            }
+
+            repaintBox = boxUnion(*repaintBox, **it);
+        }
+    }
+
+    // same boxes and batches as last frame, the order computed then still holds
+    const bool SAMELAYOUT = list.commands.size() == list.lastCommands.size() &&
+        std::ranges::equal(list.commands, list.lastCommands, [](const auto& a, const auto& b) { return a.sameLayout(b); });
+
+    if (!SAMELAYOUT) {
+        // move each command back to the last one of its batch, as long as it doesn't jump over anything it overlaps.
+        // Commands that overlap keep their order, so blending gives the same result.
+        list.order.clear();
+        for (size_t i = 0; i < list.commands.size(); ++i) {
+            const auto& CMD      = list.commands[i];
+            const auto  BOUNDS   = commandBounds(CMD);
+            size_t      insertAt = list.order.size();
+
+            for (size_t j = list.order.size(); j-- > 0;) {
+                const auto& OTHER = list.commands[list.order[j]];
+                if (OTHER.sameBatch(CMD)) {
+                    insertAt = j + 1;
+                    break;
+                }
+
+                if (commandBounds(OTHER).overlaps(BOUNDS))
+                    break;
+            }
+
+            list.order.insert(list.order.begin() + insertAt, i);
+        }
+    }
+
+    // otherwise nothing changed and the buffer is up to date
+    if (!repaintBox || !repaintBox->empty()) {
+        applyScissor(std::nullopt);
+        glClearColor(0.0, 0.0, 0.0, 0.0);
+        glClear(GL_COLOR_BUFFER_BIT);
+
+        glState.setCapability(GL_BLEND, true);
+
+        for (const auto& i : list.order) {
+            const auto& CMD = list.commands[i];
+
+            if (repaintBox && !damageBounds(CMD).overlaps(*repaintBox))
+                continue;
+
+            applyScissor(commandScissor(CMD));
+            draw(CMD);
+        }
+    }
+
+    repaintBox.reset();
+    glState.setCapability(GL_SCISSOR_TEST, false);
+
+    std::swap(list.commands, list.lastCommands);
+    list.commands.clear();
 }
 
 std::vector<std::unique_ptr<IWidget>>* CRenderer::getOrCreateWidgetsFor(const CSessionLockSurface* surf) {
@@ -406,156 +1027,124 @@ std::vector<std::unique_ptr<IWidget>>* CRenderer::getOrCreateWidgetsFor(const CS
 }
 
 void CRenderer::blurFB(const CFramebuffer& outfb, SBlurParams params) {
-    glDisable(GL_BLEND);
-    glDisable(GL_STENCIL_TEST);
+    glState.setCapability(GL_BLEND, false);
+    glState.setCapability(GL_STENCIL_TEST, false);
+
+    // the passes set it to the size of each level
+    GLint viewport[4];
+    glGetIntegerv(GL_VIEWPORT, viewport);
 
+    // covers whatever is bound, all levels are drawn with it
     CBox box{0, 0, outfb.m_vSize.x, outfb.m_vSize.y};
     box.round();
-    Mat3x3       matrix   = projMatrix.projectBox(box, HYPRUTILS_TRANSFORM_NORMAL, 0);
-    Mat3x3       glMatrix = projection.copy().multiply(matrix);
-
-    CFramebuffer mirrors[2];
-    mirrors[0].alloc(outfb.m_vSize.x, outfb.m_vSize.y, true);
-    mirrors[1].alloc(outfb.m_vSize.x, outfb.m_vSize.y, true);
-
-    CFramebuffer* currentRenderToFB = &mirrors[0];
-
-    // Begin with base color adjustments - global brightness and contrast
-    // TODO: make this a part of the first pass maybe to save on a drawcall?
-    {
-        mirrors[1].bind();
-
-        glActiveTexture(GL_TEXTURE0);
-
-        glBindTexture(outfb.m_cTex.m_iTarget, outfb.m_cTex.m_iTexID);
-
-        glTexParameteri(outfb.m_cTex.m_iTarget, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-
-        glUseProgram(blurPrepareShader.program);
-
-        glUniformMatrix3fv(blurPrepareShader.proj, 1, GL_TRUE, glMatrix.getMatrix().data());
-        glUniform1f(blurPrepareShader.contrast, params.contrast);
-        glUniform1f(blurPrepareShader.brightness, params.brightness);
-        glUniform1i(blurPrepareShader.tex, 0);
-
-        glVertexAttribPointer(blurPrepareShader.posAttrib, 2, GL_FLOAT, GL_FALSE, 0, fullVerts);
-        glVertexAttribPointer(blurPrepareShader.texAttrib, 2, GL_FLOAT, GL_FALSE, 0, fullVerts);
-
-        glEnableVertexAttribArray(blurPrepareShader.posAttrib);
-        glEnableVertexAttribArray(blurPrepareShader.texAttrib);
-
-        glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
-
-        glDisableVertexAttribArray(blurPrepareShader.posAttrib);
-        glDisableVertexAttribArray(blurPrepareShader.texAttrib);
-
-        currentRenderToFB = &mirrors[1];
+    Mat3x3 matrix   = projMatrix.projectBox(box, HYPRUTILS_TRANSFORM_NORMAL, 0);
+    Mat3x3 glMatrix = Mat3x3::outputProjection(box.size(), HYPRUTILS_TRANSFORM_NORMAL).multiply(matrix);
+
+    // level 0 is full size, each one after it half the one before. The down passes go along the chain and the up passes back
+    std::vector<CFramebuffer*> levels;
+    Vector2D                   levelSize = box.size();
+    for (int i = 0; i <= params.passes; ++i) {
+        levels.emplace_back(framebufferPool.acquire(levelSize, true));
+        levelSize = Vector2D{std::max(1.0, std::round(levelSize.x / 2.0)), std::max(1.0, std::round(levelSize.y / 2.0))};
     }
 
-    // declare the draw func
-    auto drawPass = [&](CShader* pShader) {
-        if (currentRenderToFB == &mirrors[0])
-            mirrors[1].bind();
-        else
-            mirrors[0].bind();
-
-        glActiveTexture(GL_TEXTURE0);
-
-        glBindTexture(currentRenderToFB->m_cTex.m_iTarget, currentRenderToFB->m_cTex.m_iTexID);
-
-        glTexParameteri(currentRenderToFB->m_cTex.m_iTarget, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-
-        glUseProgram(pShader->program);
-
-        // prep two shaders
-        glUniformMatrix3fv(pShader->proj, 1, GL_TRUE, glMatrix.getMatrix().data());
-        glUniform1f(pShader->radius, params.size);
-        if (pShader == &blurShader1) {
-            glUniform2f(blurShader1.halfpixel, 0.5f / (outfb.m_vSize.x / 2.f), 0.5f / (outfb.m_vSize.y / 2.f));
-            glUniform1i(blurShader1.passes, params.passes);
-            glUniform1f(blurShader1.vibrancy, params.vibrancy);
-            glUniform1f(blurShader1.vibrancy_darkness, params.vibrancy_darkness);
-        } else
-            glUniform2f(blurShader2.halfpixel, 0.5f / (outfb.m_vSize.x * 2.f), 0.5f / (outfb.m_vSize.y * 2.f));
-        glUniform1i(pShader->tex, 0);
-
-        glVertexAttribPointer(pShader->posAttrib, 2, GL_FLOAT, GL_FALSE, 0, fullVerts);
-        glVertexAttribPointer(pShader->texAttrib, 2, GL_FLOAT, GL_FALSE, 0, fullVerts);
-
-        glEnableVertexAttribArray(pShader->posAttrib);
-        glEnableVertexAttribArray(pShader->texAttrib);
+    // draws from one texture to a whole framebuffer. The offsets are the ones the full-size passes used, in full-size texels,
+    // which is 2^level times as much of a level's texture coordinates.
+    const Vector2D FULLSIZE = box.size();
+    auto           drawPass = [&](CShader& shader, const CTexture& from, const CFramebuffer& to, int fromLevel) {
+        const float LEVELSCALE = (float)(1 << fromLevel);
+        to.bind();
+
+        glState.bindTexture(from.m_iTarget, from.m_iTexID);
+        glTexParameteri(from.m_iTarget, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+
+        useProgram(shader);
+
+        glState.uniformMatrix3fv(shader.proj, glMatrix.getMatrix().data());
+        glState.uniform1i(shader.tex, 0);
+
+        if (&shader == &blurPrepareShader) {
+            glState.uniform1f(blurPrepareShader.contrast, params.contrast);
+            glState.uniform1f(blurPrepareShader.brightness, params.brightness);
+        } else if (&shader == &blurShader1) {
+            glState.uniform1f(blurShader1.radius, params.size);
+            glState.uniform2f(blurShader1.halfpixel, 0.5f / (FULLSIZE.x / 2.f) * LEVELSCALE, 0.5f / (FULLSIZE.y / 2.f) * LEVELSCALE);
+            glState.uniform1i(blurShader1.passes, params.passes);
+            glState.uniform1f(blurShader1.vibrancy, params.vibrancy);
+            glState.uniform1f(blurShader1.vibrancy_darkness, params.vibrancy_darkness);
+        } else if (&shader == &blurShader2) {
+            glState.uniform1f(blurShader2.radius, params.size);
+            glState.uniform2f(blurShader2.halfpixel, 0.5f / (FULLSIZE.x * 2.f) * LEVELSCALE, 0.5f / (FULLSIZE.y * 2.f) * LEVELSCALE);
+        } else {
+            glState.uniform1f(blurFinishShader.noise, params.noise);
+            glState.uniform1f(blurFinishShader.brightness, params.brightness);
+            glState.uniform1i(blurFinishShader.colorize, params.colorize.has_value());
+            if (params.colorize.has_value())
+                glState.uniform3f(blurFinishShader.colorizeTint, params.colorize->r, params.colorize->g, params.colorize->b);
+            glState.uniform1f(blurFinishShader.boostA, params.boostA);
+        }
 
         glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
-
-        glDisableVertexAttribArray(pShader->posAttrib);
-        glDisableVertexAttribArray(pShader->texAttrib);
-
-        if (currentRenderToFB != &mirrors[0])
-            currentRenderToFB = &mirrors[0];
-        else
-            currentRenderToFB = &mirrors[1];
     };
 
-    // draw the things.
-    // first draw is swap -> mirr
-    mirrors[0].bind();
-    glBindTexture(mirrors[1].m_cTex.m_iTarget, mirrors[1].m_cTex.m_iTexID);
+    // Begin with base color adjustments - global brightness and contrast
+    drawPass(blurPrepareShader, outfb.m_cTex, *levels[0], 0);
 
     for (int i = 1; i <= params.passes; ++i) {
-        drawPass(&blurShader1); // down
+        drawPass(blurShader1, levels[i - 1]->m_cTex, *levels[i], i - 1); // down
     }
 
-    for (int i = params.passes - 1; i >= 0; --i) {
-        drawPass(&blurShader2); // up
+    for (int i = params.passes; i >= 1; --i) {
+        drawPass(blurShader2, levels[i]->m_cTex, *levels[i - 1], i); // up
     }
 
-    // finalize the image
-    {
-        if (currentRenderToFB == &mirrors[0])
-            mirrors[1].bind();
-        else
-            mirrors[0].bind();
+    // finalize the image right into outfb, its contents were read by the first pass
+    drawPass(blurFinishShader, levels[0]->m_cTex, outfb, 0);
 
-        glActiveTexture(GL_TEXTURE0);
-
-        glBindTexture(currentRenderToFB->m_cTex.m_iTarget, currentRenderToFB->m_cTex.m_iTexID);
-
-        glTexParameteri(currentRenderToFB->m_cTex.m_iTarget, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    for (const auto& level : levels) {
+        framebufferPool.release(level);
+    }
 
-        glUseProgram(blurFinishShader.program);
+    glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+    glState.setCapability(GL_BLEND, true);
+}
 
-        glUniformMatrix3fv(blurFinishShader.proj, 1, GL_TRUE, glMatrix.getMatrix().data());
-        glUniform1f(blurFinishShader.noise, params.noise);
-        glUniform1f(blurFinishShader.brightness, params.brightness);
-        glUniform1i(blurFinishShader.colorize, params.colorize.has_value());
-        if (params.colorize.has_value())
-            glUniform3f(blurFinishShader.colorizeTint, params.colorize->r, params.colorize->g, params.colorize->b);
-        glUniform1f(blurFinishShader.boostA, params.boostA);
+void CRenderer::startCapture() {
+    captures.emplace_back(boundFBs.size(), std::vector<SDrawCommand>{});
+}
 
-        glUniform1i(blurFinishShader.tex, 0);
+std::vector<CRenderer::SDrawCommand> CRenderer::endCapture() {
+    auto commands = std::move(captures.back().second);
+    captures.pop_back();
+    return commands;
+}
 
-        glVertexAttribPointer(blurFinishShader.posAttrib, 2, GL_FLOAT, GL_FALSE, 0, fullVerts);
-        glVertexAttribPointer(blurFinishShader.texAttrib, 2, GL_FLOAT, GL_FALSE, 0, fullVerts);
+void CRenderer::drawCommands(std::vector<SDrawCommand> commands, const Vector2D& offset) {
+    for (auto& cmd : commands) {
+        cmd.box.translate(offset);
+        for (auto& inst : cmd.instances) {
+            inst.box.translate(offset);
+        }
 
-        glEnableVertexAttribArray(blurFinishShader.posAttrib);
-        glEnableVertexAttribArray(blurFinishShader.texAttrib);
+        if (cmd.scissor) {
+            cmd.scissor->at(0) += offset.x;
+            cmd.scissor->at(1) += offset.y;
+        }
 
-        glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+        applyScissor(commandScissor(cmd));
+        draw(cmd);
+    }
 
-        glDisableVertexAttribArray(blurFinishShader.posAttrib);
-        glDisableVertexAttribArray(blurFinishShader.texAttrib);
+    glState.setCapability(GL_SCISSOR_TEST, false);
+}
 
-        if (currentRenderToFB != &mirrors[0])
-            currentRenderToFB = &mirrors[0];
-        else
-            currentRenderToFB = &mirrors[1];
+CBox CRenderer::commandsBounds(const std::vector<SDrawCommand>& commands) {
+    CBox bounds;
+    for (const auto& cmd : commands) {
+        bounds = boxUnion(bounds, damageBounds(cmd));
     }
 
-    // finish
-    outfb.bind();
-    renderTexture(box, currentRenderToFB->m_cTex, 1.0, 0, HYPRUTILS_TRANSFORM_NORMAL);
-
-    glEnable(GL_BLEND);
+    return bounds;
 }
 
 void CRenderer::pushFb(GLint fb) {
@@ -563,6 +1152,11 @@ void CRenderer::pushFb(GLint fb) {
     glBindFramebuffer(GL_DRAW_FRAMEBUFFER, fb);
 }
 
+void CRenderer::pushFb(const CFramebuffer& fb) {
+    damageTexture(fb.m_cTex.m_iTexID);
+    pushFb(fb.m_iFb);
+}
+
 void CRenderer::popFb() {
     boundFBs.pop_back();
     glBindFramebuffer(GL_DRAW_FRAMEBUFFER, boundFBs.empty() ? 0 : boundFBs.back());
@@ -570,4 +1164,57 @@ void CRenderer::popFb() {
 
 void CRenderer::removeWidgetsFor(const CSessionLockSurface* surf) {
     widgets.erase(surf);
+    drawLists.erase(surf);
+}
+
+void CRenderer::reset() {
+    widgets.clear();
+    drawLists.clear();
+    framebufferPool.clear();
+    firstFullFrame = false;
+    opacity.setDuration(std::chrono::milliseconds(500));
+    opacity.warp(0.0);
+}
+
+size_t CRenderer::refreshWidgets(const std::string& id) {
+    // cached output would be shown again, labels on all outputs share one new run instead
+    std::unordered_set<std::string> commands;
+    for (auto& [surf, surfaceWidgets] : widgets) {
+        for (auto& w : surfaceWidgets) {
+            const auto PLABEL = dynamic_cast<CLabel*>(w.get());
+            if (w->widgetID == id && PLABEL && !PLABEL->command().empty())
+                commands.insert(PLABEL->command());
+        }
+    }
+
+    for (const auto& cmd : commands) {
+        g_pHyprlock->m_pProcessExecutor->invalidateShared(cmd);
+    }
+
+    size_t refreshed = 0;
+    for (auto& [surf, surfaceWidgets] : widgets) {
+        for (auto& w : surfaceWidgets) {
+            if (w->widgetID != id)
+                continue;
+
+            w->refresh();
+            refreshed++;
+        }
+    }
+
+    return refreshed;
+}
+
+void CRenderer::damageTexture(GLuint texID) {
+    for (auto& [surf, list] : drawLists) {
+        list.damagedTextures.insert(texID);
+    }
+}
+
+bool CRenderer::hasInputField(const CSessionLockSurface* surf) {
+    const auto IT = widgets.find(surf);
+    if (IT == widgets.end())
+        return true;
+
+    return std::any_of(IT->second.begin(), IT->second.end(), [](const auto& w) { return dynamic_cast<CPasswordInputField*>(w.get()) != nullptr; });
 }
\ No newline at end of file
@@ -3,22 +3,34 @@
 #include <memory>
 #include <chrono>
 #include <optional>
+#include <array>
+#include <vector>
+#include <unordered_set>
 #include "Shader.hpp"
 #include "../core/LockSurface.hpp"
+#include "../core/Animation.hpp"
 #include "../helpers/Color.hpp"
 #include "AsyncResourceGatherer.hpp"
 #include "../config/ConfigDataValues.hpp"
 #include "widgets/IWidget.hpp"
 #include "Framebuffer.hpp"
+#include "ProgramCache.hpp"
+#include "GLState.hpp"
+#include "FramebufferPool.hpp"
+#include <functional>
 
 typedef std::unordered_map<const CSessionLockSurface*, std::vector<std::unique_ptr<IWidget>>> widgetMap_t;
 
 class CRenderer {
   public:
     CRenderer();
+    ~CRenderer();
 
     struct SRenderFeedback {
-        bool needsFrame = false;
+        bool              needsFrame = false;
+        // what changed since the last frame, in buffer pixels with the origin bottom left. Only used if not the whole surface
+        bool              fullDamage = true;
+        std::vector<CBox> damage;
     };
 
     struct SBlurParams {
@@ -28,24 +40,137 @@ class CRenderer {
         float                 boostA = 1.0;
     };
 
+    // one of many quads of the same size, drawn in a single call
+    struct SQuadInstance {
+        CBox  box;
+        float alpha = 1.0;
+    };
+
+    // what the render functions below draw. While widgets draw onto the lock surface they are recorded and drawn together at the end.
+    struct SDrawCommand {
+        enum eType : uint8_t {
+            DRAW_RECT = 0,
+            DRAW_BORDER,
+            DRAW_TEXTURE,
+            DRAW_CLEAR,
+        };
+
+        eType                               type = DRAW_RECT;
+        CBox                                box;
+        int                                 rounding = 0;
+        float                               alpha    = 1.0;
+
+        CColor                              color;
+        std::vector<CColor>                 gradient;
+        float                               gradientAngle = 0;
+        int                                 thickness     = 0;
+
+        GLenum                              texTarget = GL_TEXTURE_2D;
+        GLuint                              texID     = 0;
+        std::optional<eTransform>           transform;
+
+        std::optional<std::array<GLint, 4>> scissor;
+
+        // drawn instanced if not empty, box then covers all of them
+        std::vector<SQuadInstance>          instances;
+
+        // same program and texture
+        bool                                sameBatch(const SDrawCommand& other) const;
+        // same batch, bounds and scissor, so the order of a list doesn't change
+        bool                                sameLayout(const SDrawCommand& other) const;
+        // draws exactly the same, unless the texture changed
+        bool                                sameContent(const SDrawCommand& other) const;
+    };
+
     SRenderFeedback                         renderLock(const CSessionLockSurface& surface);
 
     void                                    renderRect(const CBox& box, const CColor& col, int rounding = 0);
     void                                    renderBorder(const CBox& box, const CGradientValueData& gradient, int thickness, int rounding = 0, float alpha = 1.0);
     void                                    renderTexture(const CBox& box, const CTexture& tex, float a = 1.0, int rounding = 0, std::optional<eTransform> tr = {});
     void                                    blurFB(const CFramebuffer& outfb, SBlurParams params);
+    // the alpha of each instance scales col, or the texture
+    void                                    renderRectInstances(const std::vector<SQuadInstance>& instances, const CColor& col, int rounding = 0);
+    void                                    renderTextureInstances(const std::vector<SQuadInstance>& instances, const CTexture& tex, int rounding = 0);
+    // clears the box to transparent
+    void                                    clearBox(const CBox& box);
+
+    // the render calls onto the framebuffer bound now are kept until endCapture, instead of drawn
+    void                                    startCapture();
+    std::vector<SDrawCommand>               endCapture();
+    // draws captured commands into whatever is bound, moved by offset
+    void                                    drawCommands(std::vector<SDrawCommand> commands, const Vector2D& offset);
+    // what captured commands may cover
+    CBox                                    commandsBounds(const std::vector<SDrawCommand>& commands);
 
     std::unique_ptr<CAsyncResourceGatherer> asyncResourceGatherer;
-    std::chrono::system_clock::time_point   firstFullFrameTime;
+    // all state changes of the renderer and widgets go through this
+    CGLState                                glState;
+    // for temporary framebuffers, shared by all outputs
+    CFramebufferPool                        framebufferPool;
 
     void                                    pushFb(GLint fb);
+    // also damages wherever the framebuffer is shown
+    void                                    pushFb(const CFramebuffer& fb);
     void                                    popFb();
 
     void                                    removeWidgetsFor(const CSessionLockSurface* surf);
+    // back to before the first frame, for the next lock of the daemon
+    void                                    reset();
+    // true if the surface's widgets include an input field, or aren't created yet
+    bool                                    hasInputField(const CSessionLockSurface* surf);
+    // refreshes the widgets with this id on all outputs, returns how many
+    size_t                                  refreshWidgets(const std::string& id);
+    // the contents of the texture changed, everything showing it is redrawn in the next frame
+    void                                    damageTexture(GLuint texID);
 
   private:
     widgetMap_t                            widgets;
 
+    struct SDrawList {
+        std::vector<SDrawCommand> commands;
+        // of the previous frame, to tell whether order can be reused
+        std::vector<SDrawCommand> lastCommands;
+        std::vector<size_t>       order;
+
+        // how many of the commands come from the static widgets at the bottom
+        size_t                    staticCommands = 0;
+        // those commands of the last frame, and the ones layerFB was drawn from
+        std::vector<SDrawCommand> lastStaticCommands;
+        std::vector<SDrawCommand> layerCommands;
+        CFramebuffer              layerFB;
+
+        // damaged since the last frame
+        std::unordered_set<GLuint>       damagedTextures;
+        // the bounds of what was damaged in the last frames, newest last. nullopt if a frame was damaged entirely
+        std::vector<std::optional<CBox>> damageHistory;
+        bool                             fullDamage = true;
+    };
+
+    std::unordered_map<const CSessionLockSurface*, SDrawList> drawLists;
+    // the surface whose widgets are drawing right now
+    const CSessionLockSurface*                                recordingFor = nullptr;
+    // started captures, innermost last, with the depth of boundFBs they capture at
+    std::vector<std::pair<size_t, std::vector<SDrawCommand>>> captures;
+
+    void                                                      submit(SDrawCommand&& cmd);
+    void                                                      draw(const SDrawCommand& cmd);
+    void                                                      drawRect(const SDrawCommand& cmd);
+    void                                                      drawBorder(const SDrawCommand& cmd);
+    void                                                      drawTexture(const SDrawCommand& cmd);
+    void                                                      drawInstances(const SDrawCommand& cmd);
+    void                                                      drawClear(const SDrawCommand& cmd);
+    // sorts the recorded commands by program and texture where they don't overlap, then draws what the back buffer lacks
+    void                                                      flushDrawList(const CSessionLockSurface* surf, int bufferAge, SRenderFeedback& feedback);
+    // replaces the static commands with layerFB, redrawing it once they stopped changing
+    void                                                      useStaticLayer(SDrawList& list, const Vector2D& size);
+    // what changed compared to the last frame of the list
+    std::vector<CBox>                                         frameDamage(SDrawList& list, const CBox& surfaceBox);
+    // scissors to the box within what is repainted, or only to that without a box
+    void                                                      applyScissor(std::optional<CBox> box);
+
+    // the part of the surface being repainted by flushDrawList, nullopt for all of it
+    std::optional<CBox>                                       repaintBox;
+
     std::vector<std::unique_ptr<IWidget>>* getOrCreateWidgetsFor(const CSessionLockSurface* surf);
 
     CShader                                rectShader;
@@ -55,11 +180,53 @@ class CRenderer {
     CShader                                blurPrepareShader;
     CShader                                blurFinishShader;
     CShader                                borderShader;
+    CShader                                instancedRectShader;
+    CShader                                instancedTexShader;
+
+    // compiled when first used, or earlier if the configured widgets are going to draw with it
+    struct SPendingProgram {
+        CShader*                      shader = nullptr;
+        std::string                   vert, frag;
+        std::function<void(CShader&)> getLocations;
+
+        bool                          needed     = false;
+        bool                          started    = false;
+        GLuint                        vertShader = 0, fragShader = 0;
+    };
+
+    std::vector<SPendingProgram>           pendingPrograms;
+    GLuint                                 quadVBO     = 0;
+    GLuint                                 instanceVBO = 0;
+
+    // per instance attributes of INSTANCEDVERTSRC
+    struct SInstanceData {
+        float matrix[9];
+        float topLeft[2];
+        float alpha;
+    };
+
+    std::vector<SInstanceData>             instanceData;
+    std::unique_ptr<CProgramCache>         programCache;
+    bool                                   parallelCompile = false;
+
+    void                                   addProgram(CShader& shader, const std::string& vert, const std::string& frag, bool needed, std::function<void(CShader&)> getLocations);
+    void                                   startProgram(SPendingProgram& pending);
+    void                                   finishProgram(SPendingProgram& pending);
+    // waits for the program if it is still compiling
+    void                                   ensureProgram(CShader& shader);
+    // binds the program and its vao
+    void                                   useProgram(CShader& shader);
+    // finishes needed programs without blocking, or one at a time without parallel compile
+    void                                   finishIdlePrograms();
 
     Mat3x3                                 projMatrix = Mat3x3::identity();
     Mat3x3                                 projection;
 
     std::vector<GLint>                     boundFBs;
+
+    // fade in and out of the whole lockscreen
+    CAnimation                             opacity        = {0.f, std::chrono::milliseconds(500)};
+    bool                                   firstFullFrame = false;
 };
 
 inline std::unique_ptr<CRenderer> g_pRenderer;
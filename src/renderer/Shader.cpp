@@ -18,6 +18,8 @@ CShader::~CShader() {
 
 void CShader::destroy() {
     glDeleteProgram(program);
+    glDeleteVertexArrays(1, &vao);
 
     program = 0;
+    vao     = 0;
 }
\ No newline at end of file
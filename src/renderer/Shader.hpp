@@ -9,6 +9,7 @@ class CShader {
     ~CShader();
 
     GLuint  program           = 0;
+    GLuint  vao               = 0;
     GLint   proj              = -1;
     GLint   color             = -1;
     GLint   alphaMatte        = -1;
@@ -64,6 +65,11 @@ class CShader {
     GLint colorizeTint = -1;
     GLint boostA       = -1;
 
+    // instanced, rows of the matrix of each quad
+    GLint instanceRowAttribs[3] = {-1, -1, -1};
+    GLint instanceTopLeftAttrib = -1;
+    GLint instanceAlphaAttrib   = -1;
+
     GLint getUniformLocation(const std::string&);
 
     void  destroy();
@@ -129,6 +129,70 @@ void main() {
     gl_FragColor = pixColor * alpha;
 })#";
 
+// many quads of the same size in one draw. Each instance brings its own projected matrix (as rows), top left and alpha.
+inline const std::string INSTANCEDVERTSRC = R"#(
+attribute vec2 pos;
+attribute vec2 texcoord;
+attribute vec3 instanceRow0;
+attribute vec3 instanceRow1;
+attribute vec3 instanceRow2;
+attribute vec2 instanceTopLeft;
+attribute float instanceAlpha;
+varying vec2 v_texcoord;
+varying vec2 topLeft;
+varying float v_alpha;
+
+void main() {
+    vec3 p = vec3(pos, 1.0);
+    gl_Position = vec4(dot(instanceRow0, p), dot(instanceRow1, p), dot(instanceRow2, p), 1.0);
+    v_texcoord = texcoord;
+    topLeft = instanceTopLeft;
+    v_alpha = instanceAlpha;
+})#";
+
+inline const std::string INSTANCEDQUADFRAGSRC = R"#(
+precision highp float;
+varying vec2 topLeft;
+varying float v_alpha;
+
+uniform vec4 color;
+uniform vec2 fullSize;
+uniform float radius;
+
+void main() {
+
+    vec4 pixColor = color * v_alpha;
+
+    if (radius > 0.0) {
+	)#" +
+    ROUNDED_SHADER_FUNC("pixColor") + R"#(
+    }
+
+    gl_FragColor = pixColor;
+})#";
+
+inline const std::string INSTANCEDTEXFRAGSRC = R"#(
+precision highp float;
+varying vec2 v_texcoord;
+varying vec2 topLeft;
+varying float v_alpha;
+
+uniform sampler2D tex;
+uniform vec2 fullSize;
+uniform float radius;
+
+void main() {
+
+    vec4 pixColor = texture2D(tex, v_texcoord);
+
+    if (radius > 0.0) {
+    )#" +
+    ROUNDED_SHADER_FUNC("pixColor") + R"#(
+    }
+
+    gl_FragColor = pixColor * v_alpha;
+})#";
+
 inline const std::string FRAGBLUR1 = R"#(
 #version 100
 precision            highp float;
@@ -240,7 +304,7 @@ vec3 hsl2rgb(vec3 col) {
 }
 
 void main() {
-    vec2 uv = v_texcoord * 2.0;
+    vec2 uv = v_texcoord;
 
     vec4 sum = texture2D(tex, uv) * 4.0;
     sum += texture2D(tex, uv - halfpixel.xy * radius);
@@ -283,7 +347,7 @@ uniform float radius;
 uniform vec2 halfpixel;
 
 void main() {
-    vec2 uv = v_texcoord / 2.0;
+    vec2 uv = v_texcoord;
 
     vec4 sum = texture2D(tex, uv + vec2(-halfpixel.x * 2.0, 0.0) * radius);
 
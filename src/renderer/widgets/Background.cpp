@@ -20,6 +20,10 @@ void CBackground::renderRect(CColor color) {
     g_pRenderer->renderRect(monbox, color, 0);
 }
 
+bool CBackground::isStatic() {
+    return true;
+}
+
 bool CBackground::draw(const SRenderData& data) {
 
     if (resourceID.empty()) {
@@ -68,7 +72,7 @@ bool CBackground::draw(const SRenderData& data) {
             texbox.x = -(texbox.w - viewport.x) / 2.f;
         texbox.round();
         blurredFB.alloc(viewport.x, viewport.y); // TODO 10 bit
-        blurredFB.bind();
+        g_pRenderer->pushFb(blurredFB);
 
         g_pRenderer->renderTexture(texbox, asset->texture, 1.0, 0,
                                    isScreenshot ?
@@ -76,7 +80,7 @@ bool CBackground::draw(const SRenderData& data) {
                                        HYPRUTILS_TRANSFORM_NORMAL); // this could be omitted but whatever it's only once and makes code cleaner plus less blurring on large texs
         if (blurPasses > 0)
             g_pRenderer->blurFB(blurredFB, CRenderer::SBlurParams{blurSize, blurPasses, noise, contrast, brightness, vibrancy, vibrancy_darkness});
-        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+        g_pRenderer->popFb();
     }
 
     CTexture* tex = blurredFB.isAllocated() ? &blurredFB.m_cTex : &asset->texture;
@@ -1,9 +1,10 @@
 #include "IWidget.hpp"
 #include "../../helpers/Log.hpp"
 #include "../../core/hyprlock.hpp"
-#include "../../core/Auth.hpp"
-#include "../../core/Fingerprint.hpp"
+#include "../../core/DataProviders.hpp"
 #include <chrono>
+#include <cstring>
+#include <ctime>
 #include <unistd.h>
 #include <pwd.h>
 #include <hyprutils/string/String.hpp>
@@ -141,6 +142,46 @@ static std::string getTime12h() {
     return (HRS == 12 || HRS == 0 ? "12" : (HRS % 12 < 10 ? "0" : "") + std::to_string(HRS % 12)) + ":" + (MINS < 10 ? "0" : "") + std::to_string(MINS) + (HRS < 12 ? " AM" : " PM");
 }
 
+// $DATE[format] with a strftime format, $DATE alone is %Y-%m-%d. Returns how often the result changes, a day meaning at local midnight.
+static std::chrono::seconds replaceAllDate(std::string& str) {
+    const auto           NOW = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
+    tm                   local;
+    localtime_r(&NOW, &local);
+
+    std::chrono::seconds alignment = std::chrono::days(1);
+    size_t               pos       = 0;
+
+    while ((pos = str.find("$DATE", pos)) != std::string::npos) {
+        std::string format = "%Y-%m-%d";
+        size_t      length = 5;
+
+        if (str.substr(pos, 6).ends_with('[') && str.substr(pos).contains(']')) {
+            format = str.substr(pos + 6, str.find_first_of(']', pos) - 6 - pos);
+            length = 7 + format.length();
+        }
+
+        // anything showing seconds needs a second update, the time of day a minute one. Dates only change at midnight.
+        for (const auto& spec : {"%H", "%I", "%k", "%l", "%M", "%R", "%p", "%P"}) {
+            if (format.contains(spec))
+                alignment = std::min<std::chrono::seconds>(alignment, std::chrono::minutes(1));
+        }
+
+        for (const auto& spec : {"%S", "%s", "%T", "%r", "%X", "%c", "%+"}) {
+            if (format.contains(spec))
+                alignment = std::chrono::seconds(1);
+        }
+
+        char buf[256] = {0};
+        if (strftime(buf, sizeof(buf), format.c_str(), &local) == 0 && !format.empty())
+            Debug::log(ERR, "$DATE[{}] is empty or too long", format);
+
+        str.replace(pos, length, buf);
+        pos += strlen(buf);
+    }
+
+    return alignment;
+}
+
 IWidget::SFormatResult IWidget::formatString(std::string in) {
 
     auto  uidPassword = getpwuid(getuid());
@@ -160,40 +201,34 @@ IWidget::SFormatResult IWidget::formatString(std::string in) {
 
     if (in.contains("$TIME12")) {
         replaceInString(in, "$TIME12", getTime12h());
-        result.updateEveryMs = result.updateEveryMs != 0 && result.updateEveryMs < 1000 ? result.updateEveryMs : 1000;
+        result.updateAlignment = std::chrono::minutes(1);
     }
 
     if (in.contains("$TIME")) {
         replaceInString(in, "$TIME", getTime());
-        result.updateEveryMs = result.updateEveryMs != 0 && result.updateEveryMs < 1000 ? result.updateEveryMs : 1000;
+        result.updateAlignment = std::chrono::minutes(1);
     }
 
-    if (in.contains("$FAIL")) {
-        const auto FAIL = g_pAuth->getLastFailText();
-        replaceInString(in, "$FAIL", FAIL.has_value() ? FAIL.value() : "");
-        result.allowForceUpdate = true;
-    }
-
-    if (in.contains("$PROMPT")) {
-        const auto PROMPT = g_pAuth->getLastPrompt();
-        replaceInString(in, "$PROMPT", PROMPT.has_value() ? PROMPT.value() : "");
-        result.allowForceUpdate = true;
+    if (in.contains("$DATE")) {
+        const auto ALIGNMENT   = replaceAllDate(in);
+        result.updateAlignment = result.updateAlignment.count() == 0 ? ALIGNMENT : std::min(result.updateAlignment, ALIGNMENT);
     }
 
+    // these two take arguments, the providers only tell when they change
     if (in.contains("$ATTEMPTS")) {
         replaceAllAttempts(in);
-        result.allowForceUpdate = true;
+        result.providers.push_back("ATTEMPTS");
     }
 
     if (in.contains("$LAYOUT")) {
         replaceAllLayout(in);
-        result.allowForceUpdate = true;
+        result.providers.push_back("LAYOUT");
     }
 
-    if (in.contains("$FPRINTMESSAGE")) {
-        const auto FPRINTMESSAGE = g_pFingerprint->getLastMessage();
-        replaceInString(in, "$FPRINTMESSAGE", FPRINTMESSAGE.has_value() ? FPRINTMESSAGE.value() : "");
-        result.allowForceUpdate = true;
+    // $FAIL, $PROMPT, $FPRINTMESSAGE, $BATTERY and so on. Labels subscribe to them and update when they change.
+    for (const auto& name : g_pDataProviders->usedBy(in)) {
+        replaceInString(in, "$" + name, g_pDataProviders->get(name));
+        result.providers.push_back(name);
     }
 
     if (in.starts_with("cmd[") && in.contains("]")) {
@@ -210,6 +245,10 @@ IWidget::SFormatResult IWidget::formatString(std::string in) {
 
                     result.updateEveryMs = std::stoull(v.substr(7));
                 } catch (std::exception& e) { Debug::log(ERR, "Error parsing {} in cmd[]", v); }
+            } else if (v.starts_with("timeout:")) {
+                try {
+                    result.cmdTimeoutMs = std::stoull(v.substr(8));
+                } catch (std::exception& e) { Debug::log(ERR, "Error parsing {} in cmd[]", v); }
             } else {
                 Debug::log(ERR, "Unknown prop in string format {}", v);
             }
@@ -1,7 +1,9 @@
 #pragma once
 
 #include "../../helpers/Math.hpp"
+#include <chrono>
 #include <string>
+#include <vector>
 
 class IWidget {
   public:
@@ -11,17 +13,29 @@ class IWidget {
     virtual ~IWidget() = default;
 
     virtual bool     draw(const SRenderData& data) = 0;
+    // Updates the content right away, e.g. runs its command again. Used by the control socket.
+    virtual void     refresh() {}
+    // Looks the same every frame unless its assets or the layout change. The bottom ones that are get cached in one layer.
+    virtual bool     isStatic() {
+        return false;
+    }
 
     virtual Vector2D posFromHVAlign(const Vector2D& viewport, const Vector2D& size, const Vector2D& offset, const std::string& halign, const std::string& valign,
                                     const double& ang = 0);
 
     struct SFormatResult {
-        std::string formatted;
-        float       updateEveryMs    = 0; // 0 means don't (static)
-        bool        alwaysUpdate     = false;
-        bool        cmd              = false;
-        bool        allowForceUpdate = false;
+        std::string              formatted;
+        float                    updateEveryMs    = 0; // 0 means don't (static)
+        std::chrono::seconds     updateAlignment  = {}; // update on wall clock multiples of this, 0 means unaligned
+        bool                     alwaysUpdate     = false;
+        bool                     cmd              = false;
+        uint64_t                 cmdTimeoutMs     = 0; // 0 means general:command_timeout
+        bool                     allowForceUpdate = false;
+        std::vector<std::string> providers; // see CDataProviders, these tell when they change
     };
 
     virtual SFormatResult formatString(std::string in);
+
+    // from the id option, refresh targets widgets by it
+    std::string           widgetID;
 };
@@ -11,6 +11,9 @@ CImage::~CImage() {
         imageTimer->cancel();
         imageTimer.reset();
     }
+
+    if (reloadCommandID != 0)
+        g_pHyprlock->m_pProcessExecutor->cancel(reloadCommandID);
 }
 
 static void onTimer(std::shared_ptr<CTimer> self, void* data) {
@@ -30,20 +33,39 @@ static void onAssetCallbackTimer(std::shared_ptr<CTimer> self, void* data) {
 }
 
 void CImage::onTimerUpdate() {
-    const std::string OLDPATH = path;
+    if (reloadCommand.empty()) {
+        updatePath(path);
+        return;
+    }
 
-    if (!reloadCommand.empty()) {
-        path = g_pHyprlock->spawnSync(reloadCommand);
+    // the last one is still running
+    if (reloadCommandID != 0)
+        return;
 
-        if (path.ends_with('\n'))
-            path.pop_back();
+    // shared with the same image on other outputs, see CLabel::runCommand
+    const auto MAXAGE = reloadTime > 0 ? std::chrono::milliseconds(reloadTime * 1000 / 2) : std::chrono::milliseconds(1000);
 
-        if (path.starts_with("file://"))
-            path = path.substr(7);
+    reloadCommandID = g_pHyprlock->m_pProcessExecutor->executeShared(reloadCommand, MAXAGE, [this](const CProcessExecutor::SResult& result) {
+        reloadCommandID = 0;
 
-        if (path.empty())
+        std::string newPath = result.output;
+
+        if (newPath.ends_with('\n'))
+            newPath.pop_back();
+
+        if (newPath.starts_with("file://"))
+            newPath = newPath.substr(7);
+
+        if (newPath.empty())
             return;
-    }
+
+        updatePath(newPath);
+    });
+}
+
+void CImage::updatePath(const std::string& newPath) {
+    const std::string OLDPATH = path;
+    path                      = newPath;
 
     try {
         const auto MTIME = std::filesystem::last_write_time(path);
@@ -71,12 +93,22 @@ void CImage::onTimerUpdate() {
     g_pRenderer->asyncResourceGatherer->requestAsyncAssetPreload(request);
 }
 
+void CImage::refresh() {
+    onTimerUpdate();
+}
+
+bool CImage::isStatic() {
+    // 0 reloads on SIGUSR2 only
+    return reloadTime <= 0;
+}
+
 void CImage::plantTimer() {
 
     if (reloadTime == 0) {
-        imageTimer = g_pHyprlock->addTimer(std::chrono::hours(1), onTimer, this, true);
+        imageTimer = g_pHyprlock->addTimer(CTimer::FORCE_UPDATE_ONLY, onTimer, this, true);
     } else if (reloadTime > 0)
-        imageTimer = g_pHyprlock->addTimer(std::chrono::seconds(reloadTime), onTimer, this, false);
+        // second granularity, a bit of slack lets it share a wakeup with labels
+        imageTimer = g_pHyprlock->addTimer(std::chrono::seconds(reloadTime), onTimer, this, false, std::chrono::milliseconds(50));
 }
 
 CImage::CImage(const Vector2D& viewport_, COutput* output_, const std::string& resourceID_, const std::unordered_map<std::string, std::any>& props) :
@@ -95,6 +127,7 @@ CImage::CImage(const Vector2D& viewport_, COutput* output_, const std::string& r
         path          = std::any_cast<Hyprlang::STRING>(props.at("path"));
         reloadTime    = std::any_cast<Hyprlang::INT>(props.at("reload_time"));
         reloadCommand = std::any_cast<Hyprlang::STRING>(props.at("reload_cmd"));
+        widgetID      = std::any_cast<Hyprlang::STRING>(props.at("id"));
     } catch (const std::bad_any_cast& e) {
         RASSERT(false, "Failed to construct CImage: {}", e.what()); //
     } catch (const std::out_of_range& e) {
@@ -151,7 +184,7 @@ bool CImage::draw(const SRenderData& data) {
         const Vector2D FBSIZE = angle == 0 ? borderBox.size() : borderBox.size() + Vector2D{2.0, 2.0};
 
         imageFB.alloc(FBSIZE.x, FBSIZE.y, true);
-        g_pRenderer->pushFb(imageFB.m_iFb);
+        g_pRenderer->pushFb(imageFB);
         glClearColor(0.0, 0.0, 0.0, 0.0);
         glClear(GL_COLOR_BUFFER_BIT);
 
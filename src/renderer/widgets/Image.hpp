@@ -21,12 +21,17 @@ class CImage : public IWidget {
     ~CImage();
 
     virtual bool draw(const SRenderData& data);
+    virtual void refresh();
+    virtual bool isStatic();
 
     void         renderUpdate();
     void         onTimerUpdate();
     void         plantTimer();
 
   private:
+    // reloads the image if path or its modification time changed
+    void                                    updatePath(const std::string& newPath);
+
     CFramebuffer                            imageFB;
 
     int                                     size;
@@ -42,6 +47,7 @@ class CImage : public IWidget {
 
     int                                     reloadTime;
     std::string                             reloadCommand;
+    uint64_t                                reloadCommandID = 0;
     std::filesystem::file_time_type         modificationTime;
     std::shared_ptr<CTimer>                 imageTimer;
     CAsyncResourceGatherer::SPreloadRequest request;
@@ -2,18 +2,30 @@
 #include "../Renderer.hpp"
 #include "../../helpers/Log.hpp"
 #include "../../core/hyprlock.hpp"
+#include "../../core/DataProviders.hpp"
 #include "../../helpers/Color.hpp"
 #include "../../config/ConfigDataValues.hpp"
 #include <hyprlang.hpp>
 #include <stdexcept>
+#include <ctime>
 
 CLabel::~CLabel() {
     if (labelTimer) {
         labelTimer->cancel();
         labelTimer.reset();
     }
+
+    if (commandID != 0)
+        g_pHyprlock->m_pProcessExecutor->cancel(commandID);
+
+    g_pDataProviders->unsubscribe(this);
 }
 
+// labels are allowed to fire together with other timers that are due around the same time
+constexpr auto LABEL_TIMER_SLACK = std::chrono::milliseconds(10);
+// for cmd[] labels without an update interval, long enough for all outputs to be set up
+constexpr auto SHARED_COMMAND_MAX_AGE = std::chrono::seconds(1);
+
 static void onTimer(std::shared_ptr<CTimer> self, void* data) {
     if (data == nullptr)
         return;
@@ -40,6 +52,13 @@ std::string CLabel::getUniqueResourceId() {
 }
 
 void CLabel::onTimerUpdate() {
+    // done once the pending one is. Formatting now would make that look like the text is already shown
+    if (!pendingResourceID.empty()) {
+        Debug::log(TRACE, "Label update while resource {} is still pending, queued", pendingResourceID);
+        refreshQueued = true;
+        return;
+    }
+
     std::string oldFormatted = label.formatted;
 
     label = formatString(labelPreFormat);
@@ -47,11 +66,6 @@ void CLabel::onTimerUpdate() {
     if (label.formatted == oldFormatted && !label.alwaysUpdate)
         return;
 
-    if (!pendingResourceID.empty()) {
-        Debug::log(WARN, "Trying to update label, but resource {} is still pending! Skipping update.", pendingResourceID);
-        return;
-    }
-
     // request new
     request.id        = getUniqueResourceId();
     pendingResourceID = request.id;
@@ -60,14 +74,68 @@ void CLabel::onTimerUpdate() {
     request.callback     = onAssetCallback;
     request.callbackData = this;
 
-    g_pRenderer->asyncResourceGatherer->requestAsyncAssetPreload(request);
+    // the command counts as pending too, the text is requested once it is done
+    if (label.cmd)
+        runCommand();
+    else
+        g_pRenderer->asyncResourceGatherer->requestAsyncAssetPreload(request);
+}
+
+void CLabel::runCommand() {
+    // There is a label per output, they should share one run. Those fire within a few ms of each other,
+    // so half the interval catches all of them without ever skipping a run of the next interval.
+    const auto MAXAGE = label.updateEveryMs != 0 ? std::chrono::milliseconds((int)label.updateEveryMs / 2) : SHARED_COMMAND_MAX_AGE;
+
+    commandID = g_pHyprlock->m_pProcessExecutor->executeShared(
+        label.formatted, MAXAGE,
+        [this](const CProcessExecutor::SResult& result) {
+            commandID     = 0;
+            request.asset = result.output;
+            g_pRenderer->asyncResourceGatherer->requestAsyncAssetPreload(request);
+        },
+        std::chrono::milliseconds(label.cmdTimeoutMs));
 }
 
 void CLabel::plantTimer() {
+    std::chrono::steady_clock::duration timeout;
     if (label.updateEveryMs != 0)
-        labelTimer = g_pHyprlock->addTimer(std::chrono::milliseconds((int)label.updateEveryMs), onTimer, this, label.allowForceUpdate);
-    else if (label.updateEveryMs == 0 && label.allowForceUpdate)
-        labelTimer = g_pHyprlock->addTimer(std::chrono::hours(1), onTimer, this, true);
+        timeout = std::chrono::milliseconds((int)label.updateEveryMs);
+    else if (label.updateAlignment.count() == 0 && label.allowForceUpdate)
+        timeout = CTimer::FORCE_UPDATE_ONLY;
+    else if (label.updateAlignment.count() == 0)
+        return;
+
+    // Wake up right after the next wall clock boundary instead of polling, e.g. once a minute for $TIME.
+    // Timezone offsets are whole minutes, so aligning to utc works for local time too. Days end at local midnight.
+    if (label.updateAlignment.count() != 0) {
+        const auto                            NOW     = std::chrono::system_clock::now();
+        const auto                            SECONDS = std::chrono::floor<std::chrono::seconds>(NOW);
+        std::chrono::system_clock::time_point boundary;
+        if (label.updateAlignment >= std::chrono::days(1)) {
+            const auto TNOW = std::chrono::system_clock::to_time_t(NOW);
+            tm         midnight;
+            localtime_r(&TNOW, &midnight);
+            midnight.tm_hour  = 0;
+            midnight.tm_min   = 0;
+            midnight.tm_sec   = 0;
+            midnight.tm_mday  = midnight.tm_mday + 1;
+            midnight.tm_isdst = -1;
+            boundary          = std::chrono::system_clock::from_time_t(mktime(&midnight));
+        } else
+            boundary = SECONDS - SECONDS.time_since_epoch() % label.updateAlignment + label.updateAlignment;
+
+        const auto UNTIL = std::chrono::duration_cast<std::chrono::steady_clock::duration>(boundary - NOW);
+        timeout          = label.updateEveryMs != 0 ? std::min(timeout, UNTIL) : UNTIL;
+    }
+
+    // reuse the timer, the format (and with it allowForceUpdate) doesn't change
+    if (labelTimer)
+        g_pHyprlock->rearmTimer(labelTimer, timeout);
+    else {
+        labelTimer = g_pHyprlock->addTimer(timeout, onTimer, this, label.allowForceUpdate, LABEL_TIMER_SLACK);
+        // rearm on clock jumps, a minute label shouldn't be stale for a minute after resume
+        labelTimer->wallClockAligned = label.updateAlignment.count() != 0;
+    }
 }
 
 CLabel::CLabel(const Vector2D& viewport_, const std::unordered_map<std::string, std::any>& props, const std::string& output) :
@@ -75,6 +143,7 @@ CLabel::CLabel(const Vector2D& viewport_, const std::unordered_map<std::string,
     try {
         pos            = CLayoutValueData::fromAnyPv(props.at("position"))->getAbsolute(viewport_);
         labelPreFormat = std::any_cast<Hyprlang::STRING>(props.at("text"));
+        widgetID       = std::any_cast<Hyprlang::STRING>(props.at("id"));
         halign         = std::any_cast<Hyprlang::STRING>(props.at("halign"));
         valign         = std::any_cast<Hyprlang::STRING>(props.at("valign"));
         angle          = std::any_cast<Hyprlang::FLOAT>(props.at("rotate"));
@@ -94,7 +163,6 @@ CLabel::CLabel(const Vector2D& viewport_, const std::unordered_map<std::string,
         request.props["font_family"] = fontFamily;
         request.props["color"]       = labelColor;
         request.props["font_size"]   = fontSize;
-        request.props["cmd"]         = label.cmd;
 
         if (!textAlign.empty())
             request.props["text_align"] = textAlign;
@@ -108,13 +176,30 @@ CLabel::CLabel(const Vector2D& viewport_, const std::unordered_map<std::string,
     configPos = pos;
     viewport  = viewport_;
 
-    g_pRenderer->asyncResourceGatherer->requestAsyncAssetPreload(request);
+    // providers say when they change, no need to poll for them
+    for (const auto& name : label.providers) {
+        g_pDataProviders->subscribe(name, this, [this]() { refresh(); });
+    }
+
+    if (label.cmd) {
+        // nothing to show until the command is done, renderUpdate picks it up from there
+        resourceID           = "";
+        pendingResourceID    = request.id;
+        request.callback     = onAssetCallback;
+        request.callbackData = this;
+        runCommand();
+    } else
+        g_pRenderer->asyncResourceGatherer->requestAsyncAssetPreload(request);
 
     plantTimer();
 }
 
 bool CLabel::draw(const SRenderData& data) {
     if (!asset) {
+        // still waiting for the command, renderUpdate schedules a frame
+        if (resourceID.empty())
+            return false;
+
         asset = g_pRenderer->asyncResourceGatherer->getAssetByID(resourceID);
 
         if (!asset)
@@ -135,6 +220,23 @@ bool CLabel::draw(const SRenderData& data) {
     return false;
 }
 
+void CLabel::refresh() {
+    if (!pendingResourceID.empty()) {
+        refreshQueued = true;
+        return;
+    }
+
+    onTimerUpdate();
+}
+
+std::string CLabel::command() {
+    return label.cmd ? label.formatted : "";
+}
+
+bool CLabel::isStatic() {
+    return label.updateEveryMs == 0 && label.updateAlignment.count() == 0 && !label.cmd && label.providers.empty();
+}
+
 void CLabel::renderUpdate() {
     auto newAsset = g_pRenderer->asyncResourceGatherer->getAssetByID(pendingResourceID);
     if (newAsset) {
@@ -144,6 +246,11 @@ void CLabel::renderUpdate() {
         resourceID        = pendingResourceID;
         pendingResourceID = "";
         shadow.markShadowDirty();
+
+        if (refreshQueued) {
+            refreshQueued = false;
+            onTimerUpdate();
+        }
     } else {
         Debug::log(WARN, "Asset {} not available after the asyncResourceGatherer's callback!", pendingResourceID);
 
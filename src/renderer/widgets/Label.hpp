@@ -18,6 +18,10 @@ class CLabel : public IWidget {
     ~CLabel();
 
     virtual bool draw(const SRenderData& data);
+    virtual void refresh();
+    virtual bool isStatic();
+    // the cmd[] command, empty for other labels
+    std::string  command();
 
     void         renderUpdate();
     void         onTimerUpdate();
@@ -25,6 +29,8 @@ class CLabel : public IWidget {
 
   private:
     std::string                             getUniqueResourceId();
+    // runs the cmd[] command and requests the text once it is done
+    void                                    runCommand();
 
     std::string                             labelPreFormat;
     IWidget::SFormatResult                  label;
@@ -43,6 +49,9 @@ class CLabel : public IWidget {
     CAsyncResourceGatherer::SPreloadRequest request;
 
     std::shared_ptr<CTimer>                 labelTimer = nullptr;
+    uint64_t                                commandID  = 0;
+    // a refresh came in while an update was pending, done once that one is
+    bool                                    refreshQueued = false;
 
     CShadowable                             shadow;
 };
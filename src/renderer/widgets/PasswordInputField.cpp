@@ -63,7 +63,11 @@ CPasswordInputField::CPasswordInputField(const Vector2D& viewport_, const std::u
     colorState.inner       = colorConfig.inner;
     colorState.outer       = *colorConfig.outer;
     colorState.font        = colorConfig.font;
-    colorState.outerSource = colorConfig.outer;
+    colorState.outerSource = *colorConfig.outer;
+
+    colorState.transition.setDuration(std::chrono::milliseconds(colorConfig.transitionMs));
+    dots.amount.setDuration(std::chrono::milliseconds(std::max(dots.fadeMs, 0)));
+    placeholderWidth.warp(size.x);
 
     if (!dots.textFormat.empty()) {
         dots.textResourceID = std::format("input:{}-{}", (uintptr_t)this, dots.textFormat);
@@ -111,61 +115,34 @@ void CPasswordInputField::updateFade() {
         fade.fadeOutTimer.reset();
     }
 
-    if (!INPUTUSED && fade.a != 0.0 && (!fade.animated || fade.appearing)) {
+    if (!INPUTUSED && fade.alpha.goal() != 0.0) {
         if (fade.allowFadeOut || fadeTimeoutMs == 0) {
-            fade.a            = 1.0;
-            fade.animated     = true;
-            fade.appearing    = false;
-            fade.start        = std::chrono::system_clock::now();
+            fade.alpha.animateTo(0.0);
             fade.allowFadeOut = false;
         } else if (!fade.fadeOutTimer.get())
             fade.fadeOutTimer = g_pHyprlock->addTimer(std::chrono::milliseconds(fadeTimeoutMs), fadeOutCallback, this);
     }
 
-    if (INPUTUSED && fade.a != 1.0 && (!fade.animated || !fade.appearing)) {
-        fade.a         = 0.0;
-        fade.animated  = true;
-        fade.appearing = true;
-        fade.start     = std::chrono::system_clock::now();
-    }
-
-    if (fade.animated) {
-        if (fade.appearing)
-            fade.a = std::clamp(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now() - fade.start).count() / 100000.0, 0.0, 1.0);
-        else
-            fade.a = std::clamp(1.0 - std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now() - fade.start).count() / 100000.0, 0.0, 1.0);
+    if (INPUTUSED)
+        fade.alpha.animateTo(1.0);
 
-        if ((fade.appearing && fade.a == 1.0) || (!fade.appearing && fade.a == 0.0))
-            fade.animated = false;
+    const float PREVA = fade.a;
+    fade.a            = fade.alpha.value();
 
+    if (fade.a != PREVA)
         redrawShadow = true;
-    }
 }
 
 void CPasswordInputField::updateDots() {
-    if (passwordLength == dots.currentAmount)
-        return;
-
-    if (std::abs(passwordLength - dots.currentAmount) > 1) {
-        dots.currentAmount = std::clamp(dots.currentAmount, passwordLength - 1.f, passwordLength + 1.f);
-        dots.lastFrame     = std::chrono::system_clock::now();
-    }
+    if (dots.amount.goal() != passwordLength) {
+        // never lag behind more than one dot
+        if (std::abs(passwordLength - dots.currentAmount) > 1)
+            dots.amount.warp(std::clamp(dots.currentAmount, passwordLength - 1.f, passwordLength + 1.f));
 
-    const auto  DELTA = std::clamp((int)std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now() - dots.lastFrame).count(), 0, 20000);
-
-    const float TOADD = dots.fadeMs > 0 ? ((double)DELTA / 1000000.0) * (1000.0 / (double)dots.fadeMs) : 1;
-
-    if (passwordLength > dots.currentAmount) {
-        dots.currentAmount += TOADD;
-        if (dots.currentAmount > passwordLength)
-            dots.currentAmount = passwordLength;
-    } else if (passwordLength < dots.currentAmount) {
-        dots.currentAmount -= TOADD;
-        if (dots.currentAmount < passwordLength)
-            dots.currentAmount = passwordLength;
+        dots.amount.animateTo(passwordLength);
     }
 
-    dots.lastFrame = std::chrono::system_clock::now();
+    dots.currentAmount = dots.amount.value();
 }
 
 bool CPasswordInputField::draw(const SRenderData& data) {
@@ -190,19 +167,14 @@ bool CPasswordInputField::draw(const SRenderData& data) {
     updatePlaceholder();
     updateHiddenInputState();
 
-    static auto TIMER = std::chrono::system_clock::now();
-
     if (placeholder.asset) {
         const auto TARGETSIZEX = placeholder.asset->texture.m_vSize.x + inputFieldBox.h;
 
         if (size.x < TARGETSIZEX) {
-            const auto DELTA = std::clamp((int)std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now() - TIMER).count(), 8000, 20000);
-            TIMER            = std::chrono::system_clock::now();
-            forceReload      = true;
-
-            size.x += std::clamp((TARGETSIZEX - size.x) * DELTA / 100000.0, 1.0, 1000.0);
+            placeholderWidth.animateTo(TARGETSIZEX);
+            size.x = placeholderWidth.value();
 
-            if (size.x > TARGETSIZEX) {
+            if (size.x >= TARGETSIZEX) {
                 size.x       = TARGETSIZEX;
                 redrawShadow = true;
             }
@@ -211,7 +183,8 @@ bool CPasswordInputField::draw(const SRenderData& data) {
         pos = posFromHVAlign(viewport, size, configPos, halign, valign);
     } else if (size.x != configSize.x) {
         size.x = configSize.x;
-        pos    = posFromHVAlign(viewport, size, configPos, halign, valign);
+        placeholderWidth.warp(size.x);
+        pos = posFromHVAlign(viewport, size, configPos, halign, valign);
     }
 
     SRenderData shadowData = data;
@@ -231,7 +204,7 @@ bool CPasswordInputField::draw(const SRenderData& data) {
         const auto OUTERROUND = rounding == -1 ? outerBox.h / 2.0 : rounding;
         g_pRenderer->renderBorder(outerBox, outerGrad, outThick, OUTERROUND, fade.a * data.opacity);
 
-        if (passwordLength != 0 && hiddenInputState.enabled && !fade.animated && data.opacity == 1.0) {
+        if (passwordLength != 0 && hiddenInputState.enabled && !fade.alpha.running() && data.opacity == 1.0) {
             CBox     outerBoxScaled = outerBox;
             Vector2D p              = outerBox.pos();
             outerBoxScaled.translate(-p).scale(0.5).translate(p);
@@ -239,11 +212,11 @@ bool CPasswordInputField::draw(const SRenderData& data) {
                 outerBoxScaled.y += outerBoxScaled.h;
             if (hiddenInputState.lastQuadrant % 2 == 1)
                 outerBoxScaled.x += outerBoxScaled.w;
-            glEnable(GL_SCISSOR_TEST);
-            glScissor(outerBoxScaled.x, outerBoxScaled.y, outerBoxScaled.w, outerBoxScaled.h);
+            g_pRenderer->glState.setCapability(GL_SCISSOR_TEST, true);
+            g_pRenderer->glState.scissor(outerBoxScaled.x, outerBoxScaled.y, outerBoxScaled.w, outerBoxScaled.h);
             g_pRenderer->renderBorder(outerBox, hiddenInputState.lastColor, outThick, OUTERROUND, fade.a * data.opacity);
-            glScissor(0, 0, viewport.x, viewport.y);
-            glDisable(GL_SCISSOR_TEST);
+            g_pRenderer->glState.scissor(0, 0, viewport.x, viewport.y);
+            g_pRenderer->glState.setCapability(GL_SCISSOR_TEST, false);
         }
     }
 
@@ -286,30 +259,30 @@ bool CPasswordInputField::draw(const SRenderData& data) {
         else if (dots.rounding == -2)
             dots.rounding = rounding == -1 ? passSize.x / 2.0 : rounding * dots.size;
 
+        // all dots in one draw, only the fading ones differ in alpha
+        dots.instances.clear();
         for (int i = 0; i < dots.currentAmount; ++i) {
             if (i < DOT_FLOORED - MAX_DOTS)
                 continue;
 
+            float alpha = DOT_ALPHA;
             if (dots.currentAmount != DOT_FLOORED) {
                 if (i == DOT_FLOORED)
-                    fontCol.a *= (dots.currentAmount - DOT_FLOORED) * data.opacity;
+                    alpha *= (dots.currentAmount - DOT_FLOORED) * data.opacity;
                 else if (i == DOT_FLOORED - MAX_DOTS)
-                    fontCol.a *= (1 - dots.currentAmount + DOT_FLOORED) * data.opacity;
+                    alpha *= (1 - dots.currentAmount + DOT_FLOORED) * data.opacity;
             }
 
             Vector2D dotPosition =
                 inputFieldBox.pos() + Vector2D{xstart + (int)inputFieldBox.w % 2 / 2.f + i * (passSize.x + passSpacing), inputFieldBox.h / 2.f - passSize.y / 2.f};
-            CBox box{dotPosition, passSize};
-            if (!dots.textFormat.empty()) {
-                if (!dots.textAsset)
-                    break;
-
-                g_pRenderer->renderTexture(box, dots.textAsset->texture, fontCol.a, dots.rounding);
-            } else {
-                g_pRenderer->renderRect(box, fontCol, dots.rounding);
-            }
-            fontCol.a = DOT_ALPHA;
+            dots.instances.push_back({CBox{dotPosition, passSize}, alpha});
         }
+
+        if (!dots.textFormat.empty()) {
+            if (dots.textAsset)
+                g_pRenderer->renderTextureInstances(dots.instances, dots.textAsset->texture, dots.rounding);
+        } else
+            g_pRenderer->renderRectInstances(dots.instances, CColor{fontCol.r, fontCol.g, fontCol.b, 1.0}, dots.rounding);
     }
 
     if (passwordLength == 0 && !placeholder.resourceID.empty()) {
@@ -329,12 +302,13 @@ bool CPasswordInputField::draw(const SRenderData& data) {
             forceReload = true;
     }
 
-    return dots.currentAmount != passwordLength || fade.animated || colorState.animated || redrawShadow || data.opacity < 1.0 || forceReload;
+    // running animations are covered by CAnimationManager::animating
+    return redrawShadow || forceReload;
 }
 
 static void failTimeoutCallback(std::shared_ptr<CTimer> self, void* data) {
     g_pAuth->m_bDisplayFailText = false;
-    g_pHyprlock->renderAllOutputs();
+    g_pHyprlock->renderInputFieldOutputs();
 }
 
 void CPasswordInputField::updatePlaceholder() {
@@ -416,56 +390,31 @@ void CPasswordInputField::updateHiddenInputState() {
     hiddenInputState.lastQuadrant = (hiddenInputState.lastQuadrant + rand() % 3 + 1) % 4;
 }
 
-static void changeChannel(const float& source, const float& target, float& subject, const double& multi, bool& animated) {
-
-    const float DELTA = target - source;
-
-    if (subject != target) {
-        subject += DELTA * multi;
-        animated = true;
-
-        if ((source < target && subject > target) || (source > target && subject < target))
-            subject = target;
-    }
+static void lerpColor(const CColor& source, const CColor& target, CColor& subject, const float progress) {
+    subject.r = source.r + (target.r - source.r) * progress;
+    subject.g = source.g + (target.g - source.g) * progress;
+    subject.b = source.b + (target.b - source.b) * progress;
+    subject.a = source.a + (target.a - source.a) * progress;
 }
 
-static void changeColor(const CColor& source, const CColor& target, CColor& subject, const double& multi, bool& animated) {
-
-    changeChannel(source.r, target.r, subject.r, multi, animated);
-    changeChannel(source.g, target.g, subject.g, multi, animated);
-    changeChannel(source.b, target.b, subject.b, multi, animated);
-    changeChannel(source.a, target.a, subject.a, multi, animated);
-}
-
-static void changeGrad(CGradientValueData* psource, CGradientValueData* ptarget, CGradientValueData& subject, const double& multi, bool& animated) {
-    if (!psource || !ptarget)
+static void lerpGrad(const CGradientValueData& source, CGradientValueData* ptarget, CGradientValueData& subject, const float progress) {
+    if (!ptarget || source.m_vColors.empty())
         return;
 
     subject.m_vColors.resize(ptarget->m_vColors.size(), subject.m_vColors.back());
 
     for (size_t i = 0; i < subject.m_vColors.size(); ++i) {
-        const CColor& sourceCol = (i < psource->m_vColors.size()) ? psource->m_vColors[i] : psource->m_vColors.back();
+        const CColor& sourceCol = (i < source.m_vColors.size()) ? source.m_vColors[i] : source.m_vColors.back();
         const CColor& targetCol = (i < ptarget->m_vColors.size()) ? ptarget->m_vColors[i] : ptarget->m_vColors.back();
-        changeColor(sourceCol, targetCol, subject.m_vColors[i], multi, animated);
+        lerpColor(sourceCol, targetCol, subject.m_vColors[i], progress);
     }
 
-    if (psource->m_fAngle != ptarget->m_fAngle) {
-        const float DELTA = ptarget->m_fAngle - psource->m_fAngle;
-        subject.m_fAngle += DELTA * multi;
-        animated = true;
-
-        if ((psource->m_fAngle < ptarget->m_fAngle && subject.m_fAngle > ptarget->m_fAngle) || (psource->m_fAngle > ptarget->m_fAngle && subject.m_fAngle < ptarget->m_fAngle))
-            subject.m_fAngle = ptarget->m_fAngle;
-    }
+    subject.m_fAngle = source.m_fAngle + (ptarget->m_fAngle - source.m_fAngle) * progress;
 }
 
 void CPasswordInputField::updateColors() {
     const bool BORDERLESS = outThick == 0;
     const bool NUMLOCK    = (colorConfig.invertNum) ? !g_pHyprlock->m_bNumLock : g_pHyprlock->m_bNumLock;
-    const auto MULTI      = colorConfig.transitionMs == 0 ?
-             1.0 :
-             std::clamp(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now() - colorState.lastFrame).count() / (double)colorConfig.transitionMs,
-                        0.0016, 0.5);
 
     //
     CGradientValueData* targetGrad = nullptr;
@@ -499,21 +448,23 @@ void CPasswordInputField::updateColors() {
     }
 
     if (targetGrad != colorState.currentTarget) {
-        colorState.outerSource = &colorState.outer;
+        // transition from wherever we are right now
+        colorState.outerSource = colorState.outer;
         colorState.innerSource = colorState.inner;
 
         colorState.currentTarget = targetGrad;
+
+        colorState.transition.warp(0.0);
+        colorState.transition.animateTo(1.0);
     }
 
-    colorState.animated = false;
+    const float PROGRESS = colorState.transition.value();
 
     if (!BORDERLESS)
-        changeGrad(colorState.outerSource, outerTarget, colorState.outer, MULTI, colorState.animated);
-    changeColor(colorState.innerSource, innerTarget, colorState.inner, MULTI, colorState.animated);
+        lerpGrad(colorState.outerSource, outerTarget, colorState.outer, PROGRESS);
+    lerpColor(colorState.innerSource, innerTarget, colorState.inner, PROGRESS);
 
     // Font color is only chaned, when `swap_font_color` is set to true and no border is present.
     // It is not animated, because that does not look good and we would need to rerender the text for each frame.
     colorState.font = fontTarget;
-
-    colorState.lastFrame = std::chrono::system_clock::now();
 }
@@ -4,7 +4,9 @@
 #include "../../helpers/Color.hpp"
 #include "../../helpers/Math.hpp"
 #include "../../core/Timer.hpp"
+#include "../../core/Animation.hpp"
 #include "Shadowable.hpp"
+#include "../Renderer.hpp"
 #include "src/config/ConfigDataValues.hpp"
 #include <chrono>
 #include <vector>
@@ -49,23 +51,22 @@ class CPasswordInputField : public IWidget {
     struct {
         float                                 currentAmount = 0;
         int                                   fadeMs        = 0;
-        std::chrono::system_clock::time_point lastFrame;
-        bool                                  center     = false;
-        float                                 size       = 0;
-        float                                 spacing    = 0;
-        int                                   rounding   = 0;
-        std::string                           textFormat = "";
-        SPreloadedAsset*                      textAsset  = nullptr;
+        CAnimation                            amount        = {0.f, std::chrono::milliseconds(0)};
+        bool                                  center        = false;
+        float                                 size          = 0;
+        float                                 spacing       = 0;
+        int                                   rounding      = 0;
+        std::string                           textFormat    = "";
+        SPreloadedAsset*                      textAsset     = nullptr;
         std::string                           textResourceID;
+        std::vector<CRenderer::SQuadInstance> instances;
     } dots;
 
     struct {
-        std::chrono::system_clock::time_point start;
-        float                                 a            = 0;
-        bool                                  appearing    = true;
-        bool                                  animated     = false;
-        std::shared_ptr<CTimer>               fadeOutTimer = nullptr;
-        bool                                  allowFadeOut = false;
+        CAnimation              alpha        = {0.f, std::chrono::milliseconds(100)};
+        float                   a            = 0;
+        std::shared_ptr<CTimer> fadeOutTimer = nullptr;
+        bool                    allowFadeOut = false;
     } fade;
 
     struct {
@@ -109,19 +110,20 @@ class CPasswordInputField : public IWidget {
         CColor              inner;
         CColor              font;
 
-        CGradientValueData* outerSource = nullptr;
+        CGradientValueData  outerSource;
         CColor              innerSource;
 
         CGradientValueData* currentTarget = nullptr;
 
-        bool                animated = false;
-
-        //
-        std::chrono::system_clock::time_point lastFrame;
+        // 0 to 1 from the sources to the current target
+        CAnimation          transition = {1.f, std::chrono::milliseconds(0)};
     } colorState;
 
     bool        fadeOnEmpty;
     uint64_t    fadeTimeoutMs;
 
+    // widens the field to fit the placeholder text
+    CAnimation  placeholderWidth = {0.f, std::chrono::milliseconds(150), EASE_OUT_CUBIC};
+
     CShadowable shadow;
 };
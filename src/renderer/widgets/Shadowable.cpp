@@ -14,16 +14,32 @@ void CShadowable::markShadowDirty() {
     if (passes == 0)
         return;
 
-    if (!shadowFB.isAllocated())
-        shadowFB.alloc(viewport.x, viewport.y, true);
+    g_pRenderer->startCapture();
+    ignoreDraw = true;
+    widget->draw(IWidget::SRenderData{.opacity = 1.0});
+    ignoreDraw = false;
+    const auto COMMANDS = g_pRenderer->endCapture();
+
+    // summed over the down and up passes, each one reaching about twice as far as the one before
+    const double REACH  = (2.0 * size + 3.0) * ((1 << passes) - 1);
+    const auto   BOUNDS = g_pRenderer->commandsBounds(COMMANDS).expand(REACH).intersection({{}, viewport});
+    if (BOUNDS.empty()) {
+        shadowFB.release();
+        return;
+    }
 
-    g_pRenderer->pushFb(shadowFB.m_iFb);
+    const auto X = std::floor(BOUNDS.x);
+    const auto Y = std::floor(BOUNDS.y);
+    shadowBox    = {X, Y, std::ceil(BOUNDS.x + BOUNDS.w) - X, std::ceil(BOUNDS.y + BOUNDS.h) - Y};
+
+    shadowFB.alloc(shadowBox.w, shadowBox.h, true);
+
+    g_pRenderer->pushFb(shadowFB);
     glClearColor(0.0, 0.0, 0.0, 0.0);
     glClear(GL_COLOR_BUFFER_BIT);
 
-    ignoreDraw = true;
-    widget->draw(IWidget::SRenderData{.opacity = 1.0});
-    ignoreDraw = false;
+    // the viewport is still the one of the surface, moved like this the box lands on the framebuffer
+    g_pRenderer->drawCommands(COMMANDS, {-shadowBox.x, -shadowBox.y});
 
     g_pRenderer->blurFB(shadowFB, CRenderer::SBlurParams{.size = size, .passes = passes, .colorize = color, .boostA = boostA});
 
@@ -37,7 +53,6 @@ bool CShadowable::draw(const IWidget::SRenderData& data) {
     if (!shadowFB.isAllocated() || ignoreDraw)
         return true;
 
-    CBox box = {0, 0, viewport.x, viewport.y};
-    g_pRenderer->renderTexture(box, shadowFB.m_cTex, data.opacity, 0, HYPRUTILS_TRANSFORM_NORMAL);
+    g_pRenderer->renderTexture(shadowBox, shadowFB.m_cTex, data.opacity, 0, HYPRUTILS_TRANSFORM_NORMAL);
     return true;
 }
\ No newline at end of file
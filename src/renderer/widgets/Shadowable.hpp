@@ -11,7 +11,7 @@
 
 class CShadowable {
   public:
-    CShadowable(IWidget* widget_, const std::unordered_map<std::string, std::any>& props, const Vector2D& viewport_ /* TODO: make this not the entire viewport */);
+    CShadowable(IWidget* widget_, const std::unordered_map<std::string, std::any>& props, const Vector2D& viewport_);
 
     // instantly re-renders the shadow using the widget's draw() method
     void         markShadowDirty();
@@ -28,5 +28,7 @@ class CShadowable {
     // to avoid recursive shadows
     bool         ignoreDraw = false;
 
+    // only covers what the widget draws and how far the blur spreads it
     CFramebuffer shadowFB;
+    CBox         shadowBox;
 };
\ No newline at end of file
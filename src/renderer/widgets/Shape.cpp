@@ -41,6 +41,10 @@ CShape::CShape(const Vector2D& viewport_, const std::unordered_map<std::string,
     }
 }
 
+bool CShape::isStatic() {
+    return true;
+}
+
 bool CShape::draw(const SRenderData& data) {
 
     if (firstRender) {
@@ -58,11 +62,7 @@ bool CShape::draw(const SRenderData& data) {
             g_pRenderer->renderBorder(borderBox, borderGrad, border, rounding == -1 ? PIROUND : std::clamp(rounding, 0, PIROUND), data.opacity);
         }
 
-        glEnable(GL_SCISSOR_TEST);
-        glScissor(shapeBox.x, shapeBox.y, shapeBox.width, shapeBox.height);
-        glClearColor(0.0, 0.0, 0.0, 0.0);
-        glClear(GL_COLOR_BUFFER_BIT);
-        glDisable(GL_SCISSOR_TEST);
+        g_pRenderer->clearBox(shapeBox);
 
         return data.opacity < 1.0;
     }
@@ -72,7 +72,7 @@ bool CShape::draw(const SRenderData& data) {
         const bool ALLOWROUND   = rounding > -1 && rounding < MINHALFSHAPE;
 
         shapeFB.alloc(borderBox.width + borderBox.x * 2.0, borderBox.height + borderBox.y * 2.0, true);
-        g_pRenderer->pushFb(shapeFB.m_iFb);
+        g_pRenderer->pushFb(shapeFB);
         glClearColor(0.0, 0.0, 0.0, 0.0);
         glClear(GL_COLOR_BUFFER_BIT);
 
@@ -14,6 +14,7 @@ class CShape : public IWidget {
     CShape(const Vector2D& viewport, const std::unordered_map<std::string, std::any>& props);
 
     virtual bool draw(const SRenderData& data);
+    virtual bool isStatic();
 
   private:
     CFramebuffer       shapeFB;
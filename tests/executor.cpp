@@ -0,0 +1,62 @@
+#include "src/core/ProcessExecutor.hpp"
+#include "shared.hpp"
+
+using namespace std::chrono_literals;
+
+// hands out the runs instead of spawning anything, the test finishes them
+class CFakeExecutor : public CProcessExecutor {
+  public:
+    virtual uint64_t execute(const std::string& cmd, Callback cb, std::chrono::steady_clock::duration timeout) {
+        runs.push_back(std::move(cb));
+        return runs.size();
+    }
+
+    void finishRun(size_t idx, const std::string& output) {
+        // copy, finishing may start the next run
+        const auto CB = runs[idx];
+        CB(SResult{.output = output, .exitStatus = 0});
+    }
+
+    std::vector<Callback> runs;
+};
+
+int main() {
+    int           ret = 0;
+    CFakeExecutor executor;
+    std::string   first, second, third;
+
+    // a second ask while running waits for the same run
+    executor.executeShared("date", 10s, [&first](const auto& result) { first = result.output; });
+    executor.executeShared("date", 10s, [&second](const auto& result) { second = result.output; });
+    EXPECT(executor.runs.size(), 1u);
+
+    executor.finishRun(0, "a");
+    EXPECT(first, "a");
+    EXPECT(second, "a");
+
+    // invalidated, so the cached result is not reused
+    executor.invalidateShared("date");
+    executor.executeShared("date", 10s, [&third](const auto& result) { third = result.output; });
+    EXPECT(executor.runs.size(), 2u);
+
+    // invalidated while running, the waiter gets the output of the run started after it
+    executor.invalidateShared("date");
+    executor.finishRun(1, "b");
+    EXPECT(executor.runs.size(), 3u);
+    EXPECT(third, "");
+
+    executor.finishRun(2, "c");
+    EXPECT(third, "c");
+
+    // other commands and other max ages are separate runs
+    executor.executeShared("uptime", 10s, [](const auto& result) {});
+    executor.executeShared("date", 5s, [](const auto& result) {});
+    EXPECT(executor.runs.size(), 5u);
+
+    // invalidating one command leaves the runs of another alone
+    executor.invalidateShared("uptime");
+    executor.finishRun(4, "d");
+    EXPECT(executor.runs.size(), 5u);
+
+    return ret;
+}
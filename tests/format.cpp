@@ -0,0 +1,37 @@
+#include "src/renderer/widgets/IWidget.hpp"
+#include "src/core/DataProviders.hpp"
+#include "shared.hpp"
+
+using namespace std::chrono_literals;
+
+class CTextWidget : public IWidget {
+  public:
+    virtual bool draw(const SRenderData& data) {
+        return false;
+    }
+};
+
+int main() {
+    int         ret = 0;
+    CTextWidget widget;
+    g_pDataProviders = std::make_unique<CDataProviders>();
+
+    const auto  ALIGNMENT = [&widget](const std::string& in) { return widget.formatString(in).updateAlignment.count(); };
+
+    EXPECT(ALIGNMENT("static text"), 0);
+    EXPECT(ALIGNMENT("$TIME"), std::chrono::seconds(1min).count());
+    EXPECT(ALIGNMENT("$TIME12"), std::chrono::seconds(1min).count());
+
+    // dates without a time of day change at midnight
+    EXPECT(ALIGNMENT("$DATE"), std::chrono::seconds(std::chrono::days(1)).count());
+    EXPECT(ALIGNMENT("$DATE[%A, %d %B]"), std::chrono::seconds(std::chrono::days(1)).count());
+    EXPECT(ALIGNMENT("$DATE[%H:%M]"), std::chrono::seconds(1min).count());
+    EXPECT(ALIGNMENT("$DATE[%T]"), 1);
+
+    // the most frequent one wins
+    EXPECT(ALIGNMENT("$DATE $TIME"), std::chrono::seconds(1min).count());
+    EXPECT(ALIGNMENT("$DATE[%A] $DATE[%S]"), 1);
+
+    g_pDataProviders.reset();
+    return ret;
+}
@@ -0,0 +1,75 @@
+#include "src/renderer/FramebufferPool.hpp"
+#include "shared.hpp"
+#include <optional>
+
+using namespace std::chrono_literals;
+
+// no GL and no event loop, the framebuffers only get a size
+class CTestPool : public CFramebufferPool {
+  public:
+    using CFramebufferPool::trim;
+
+    virtual std::unique_ptr<CFramebuffer> allocate(const Vector2D& size, bool highres) {
+        allocated++;
+        auto fb     = std::make_unique<CFramebuffer>();
+        fb->m_vSize = size;
+        return fb;
+    }
+
+    virtual void armTrimTimer(const std::chrono::steady_clock::time_point& at) {
+        trimAt = at;
+    }
+
+    size_t                                               allocated = 0;
+    std::optional<std::chrono::steady_clock::time_point> trimAt;
+};
+
+int main() {
+    int ret = 0;
+
+    {
+        // released ones are reused for the same size and format only
+        CTestPool  pool;
+        const auto FB = pool.acquire({800, 600}, true);
+        pool.release(FB);
+        EXPECT(pool.acquire({800, 600}, true) == FB, true);
+        EXPECT(pool.acquire({800, 600}, false) == FB, false);
+        EXPECT(pool.allocated, 2u);
+    }
+
+    {
+        // free ones unused for a while go away, the timer is armed for when that happens
+        CTestPool  pool;
+        const auto BEFORE = std::chrono::steady_clock::now();
+        pool.release(pool.acquire({800, 600}, true));
+        EXPECT(pool.trimAt.has_value() && *pool.trimAt >= BEFORE + 10s, true);
+
+        pool.trim(*pool.trimAt - 1ms);
+        pool.acquire({800, 600}, true);
+        EXPECT(pool.allocated, 1u);
+
+        pool.release(pool.acquire({640, 480}, true));
+        pool.trim(std::chrono::steady_clock::now() + 1min);
+        pool.acquire({640, 480}, true);
+        EXPECT(pool.allocated, 3u);
+    }
+
+    {
+        // over the budget of free memory, the least recently used ones go first. Each of these is about 128 MiB.
+        CTestPool  pool;
+        const auto A = pool.acquire({4096, 4096}, true);
+        const auto B = pool.acquire({4096, 4095}, true);
+        const auto C = pool.acquire({4096, 4094}, true);
+        pool.release(A);
+        pool.release(B);
+        pool.release(C);
+
+        EXPECT(pool.acquire({4096, 4095}, true) == B, true);
+        EXPECT(pool.acquire({4096, 4094}, true) == C, true);
+        EXPECT(pool.allocated, 3u);
+        pool.acquire({4096, 4096}, true);
+        EXPECT(pool.allocated, 4u);
+    }
+
+    return ret;
+}
@@ -0,0 +1,27 @@
+#include "src/core/DataProviders.hpp"
+#include "shared.hpp"
+#include <string>
+
+static std::string joined(const std::vector<std::string>& names) {
+    std::string result;
+    for (const auto& n : names) {
+        result += (result.empty() ? "" : ",") + n;
+    }
+    return result;
+}
+
+int main() {
+    int            ret = 0;
+    CDataProviders providers;
+    providers.registerProvider("BATTERY_TIME", CDataProviders::READ_ONCE, []() { return "2h"; });
+
+    EXPECT(joined(providers.usedBy("no variables")), "");
+    EXPECT(joined(providers.usedBy("BATTERY without a dollar")), "");
+    EXPECT(joined(providers.usedBy("$UPTIME")), "UPTIME");
+
+    // longer names first, so they get replaced before a shorter one that is their prefix
+    EXPECT(joined(providers.usedBy("$BATTERY_TIME")), "BATTERY_TIME,BATTERY");
+    EXPECT(joined(providers.usedBy("$FAIL on $HOSTNAME")), "HOSTNAME,FAIL");
+
+    return ret;
+}
@@ -0,0 +1,31 @@
+#include "src/core/TaskQueue.hpp"
+#include "shared.hpp"
+#include <string>
+
+int main() {
+    int         ret = 0;
+    std::string order;
+    CTaskQueue  queue;
+
+    const auto  PUSHESANOTHER = [&queue, &order]() {
+        order += "3";
+        queue.push([&order]() { order += "4"; });
+    };
+
+    // only the first push into an empty queue has to wake the consumer
+    EXPECT(queue.push([&order]() { order += "1"; }), true);
+    EXPECT(queue.push([&order]() { order += "2"; }), false);
+    EXPECT(queue.push(PUSHESANOTHER), false);
+
+    // push order, a task queued while draining waits for the next drain
+    EXPECT(queue.drain(), 3u);
+    EXPECT(order, "123");
+
+    EXPECT(queue.drain(), 1u);
+    EXPECT(order, "1234");
+
+    EXPECT(queue.drain(), 0u);
+    EXPECT(queue.push([]() {}), true);
+
+    return ret;
+}
@@ -0,0 +1,77 @@
+#include "src/core/TimerQueue.hpp"
+#include "shared.hpp"
+#include <string>
+
+using namespace std::chrono_literals;
+
+int main() {
+    int         ret = 0;
+    std::string fired;
+
+    auto        firing = [&fired](const char* name) { return [&fired, name](std::shared_ptr<CTimer>, void*) { fired += name; }; };
+
+    {
+        // A may wait for B, B may not wait at all. One wakeup at B's expiry runs both, in expiry order.
+        CTimerQueue queue;
+        const auto  A = std::make_shared<CTimer>(100ms, firing("A"), nullptr, false, 50ms);
+        const auto  B = std::make_shared<CTimer>(120ms, firing("B"), nullptr, false);
+        queue.schedule(B);
+        queue.schedule(A);
+
+        EXPECT(queue.nextDeadline() == B->expiresAt(), true);
+
+        queue.dispatch(A->expiresAt() - 1ms);
+        EXPECT(fired, "");
+
+        queue.dispatch(B->expiresAt());
+        EXPECT(fired, "AB");
+
+        // fired ones leave stale entries behind
+        EXPECT(queue.nextDeadline().has_value(), false);
+        EXPECT(queue.timers().size(), 0u);
+    }
+
+    fired.clear();
+
+    {
+        // re-arming bumps the generation, the entry of the first arm must not fire
+        CTimerQueue queue;
+        const auto  C        = std::make_shared<CTimer>(100ms, firing("C"), nullptr, false);
+        const auto  FIRSTARM = C->expiresAt();
+        const auto  FIRSTGEN = C->generation();
+        queue.schedule(C);
+
+        C->arm(300ms);
+        queue.schedule(C);
+        EXPECT(C->generation(), FIRSTGEN + 1);
+        EXPECT(queue.nextDeadline() == C->expiresAt(), true);
+        EXPECT(queue.timers().size(), 1u);
+
+        queue.dispatch(FIRSTARM);
+        EXPECT(fired, "");
+
+        queue.dispatch(C->expiresAt());
+        queue.dispatch(C->expiresAt());
+        EXPECT(fired, "C");
+    }
+
+    fired.clear();
+
+    {
+        // cancelled timers don't fire, force update only ones never set a deadline
+        CTimerQueue queue;
+        const auto  D = std::make_shared<CTimer>(100ms, firing("D"), nullptr, false);
+        const auto  E = std::make_shared<CTimer>(CTimer::FORCE_UPDATE_ONLY, firing("E"), nullptr, true);
+        queue.schedule(D);
+        queue.schedule(E);
+        D->cancel();
+
+        EXPECT(queue.nextDeadline().has_value(), false);
+        EXPECT(queue.timers().size(), 1u);
+
+        queue.dispatch(std::chrono::steady_clock::now() + 1h);
+        EXPECT(fired, "");
+    }
+
+    return ret;
+}